@@ -0,0 +1,33 @@
+#include "Arena.h"
+#include <algorithm>
+
+Arena::Arena(std::size_t blockSize) : m_blockSize{blockSize} {}
+
+auto Arena::reset() -> void {
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+auto Arena::used() const -> std::size_t { return m_used; }
+
+auto Arena::allocate(std::size_t size, std::size_t alignment) -> void * {
+    // Try the current block, then the following ones (kept from before the
+    // last reset), then add a new one.
+    for (; m_block < m_blocks.size(); ++m_block, m_offset = 0) {
+        const Block &block = m_blocks[m_block];
+        const std::size_t start =
+            (m_offset + alignment - 1) & ~(alignment - 1);
+        if (start + size <= block.size) {
+            m_offset = start + size;
+            m_used += size;
+            return block.memory.get() + start;
+        }
+    }
+    // new[] of std::byte is aligned for any fundamental type.
+    const std::size_t blockSize = std::max(m_blockSize, size);
+    m_blocks.push_back({std::make_unique<std::byte[]>(blockSize), blockSize});
+    m_offset = size;
+    m_used += size;
+    return m_blocks.back().memory.get();
+}
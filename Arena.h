@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator. Hands out memory from large blocks by moving a pointer
+// along, and frees everything at once with reset(), keeping the blocks to be
+// used again. Nothing is destroyed, so it only holds trivially destructible
+// objects.
+struct Arena {
+    // Blocks are blockSize bytes, or bigger for allocations that don't fit.
+    explicit Arena(std::size_t blockSize = 1 << 20);
+    Arena(const Arena &other) = delete;
+    auto operator=(const Arena &other) = delete;
+    Arena(Arena &&other) = default;
+
+    // Returns count value-initialized objects.
+    template <class T> auto make(std::size_t count = 1) -> T * {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "arena objects are never destroyed");
+        void *memory = allocate(sizeof(T) * count, alignof(T));
+        return new (memory) T[count]();
+    }
+
+    // Frees everything allocated so far.
+    auto reset() -> void;
+
+    // Returns the number of bytes handed out since the last reset().
+    auto used() const -> std::size_t;
+
+  private:
+    struct Block {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+    };
+
+    auto allocate(std::size_t size, std::size_t alignment) -> void *;
+
+    std::vector<Block> m_blocks = {};
+    std::size_t m_blockSize;
+    // Block being allocated from, and how far into it.
+    std::size_t m_block = 0U;
+    std::size_t m_offset = 0U;
+    std::size_t m_used = 0U;
+};
+
+#endif
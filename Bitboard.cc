@@ -0,0 +1,109 @@
+#include "Bitboard.h"
+#include <vector>
+
+namespace Bitboard {
+std::array<Magic, 64> ROOK_MAGICS;
+std::array<Magic, 64> BISHOP_MAGICS;
+
+namespace {
+// Number of entries needed for every rook and bishop tile. (Each tile needs
+// 2^n entries, where n is the number of tiles in its mask.)
+constexpr std::size_t ROOK_TABLE_SIZE = 0x19000;
+constexpr std::size_t BISHOP_TABLE_SIZE = 0x1480;
+
+std::array<u64, ROOK_TABLE_SIZE> rookTable;
+std::array<u64, BISHOP_TABLE_SIZE> bishopTable;
+
+#if !defined(BITBOARD_USE_PEXT)
+// Small xorshift generator for finding magic numbers. Seeded with a constant
+// so the tables are the same on every run.
+struct MagicRandom {
+    u64 state = 1070372U;
+
+    auto next() -> u64 {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    // Magic numbers work best with few bits set.
+    auto sparse() -> u64 { return next() & next() & next(); }
+};
+#endif
+
+// Fills in the magics for one type of slider. attacksFor returns the slow
+// (ray walking) attacks for a tile.
+template <class T>
+auto initMagics(std::array<Magic, 64> &magics, u64 *table,
+                const T &attacksFor) -> void {
+    std::vector<u64> occupancies, attacks;
+    u64 *next = table;
+#if !defined(BITBOARD_USE_PEXT)
+    MagicRandom random;
+    std::vector<int> epoch;
+    int attempt = 0;
+#endif
+
+    for (u8 sq = 0; sq < 64; ++sq) {
+        Magic &m = magics[sq];
+
+        // Pieces on the edge of the board never block anything, so they are
+        // left out of the mask (unless the slider itself is on that edge).
+        const u64 rows = (ROW_0 | ROW_7) & ~(ROW_0 << (row(sq) * 8));
+        const u64 columns =
+            (0x0101010101010101ULL | 0x8080808080808080ULL) &
+            ~(0x0101010101010101ULL << column(sq));
+        m.mask = attacksFor(sq, 0) & ~(rows | columns);
+        m.shift = 64 - count(m.mask);
+        m.attacks = next;
+
+        // Walk every subset of the mask (Carry-Rippler trick) and record
+        // the attacks for it.
+        occupancies.clear();
+        attacks.clear();
+        u64 subset = 0U;
+        do {
+            occupancies.push_back(subset);
+            attacks.push_back(attacksFor(sq, subset));
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+        next += occupancies.size();
+
+#if defined(BITBOARD_USE_PEXT)
+        for (std::size_t i = 0; i < occupancies.size(); ++i)
+            m.attacks[m.index(occupancies[i])] = attacks[i];
+#else
+        // Try random magics until one maps every subset to an entry without
+        // clashing with a subset that has different attacks. epoch tracks
+        // which entries were written by the current attempt, so the table
+        // doesn't need clearing between attempts.
+        epoch.assign(occupancies.size(), 0);
+        for (std::size_t i = 0; i < occupancies.size();) {
+            do
+                m.magic = random.sparse();
+            while (count((m.magic * m.mask) >> 56) < 6);
+
+            ++attempt;
+            for (i = 0; i < occupancies.size(); ++i) {
+                const u32 index = m.index(occupancies[i]);
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    m.attacks[index] = attacks[i];
+                } else if (m.attacks[index] != attacks[i])
+                    break;
+            }
+        }
+#endif
+    }
+}
+
+// Builds the tables before main() runs.
+struct MagicInit {
+    MagicInit() {
+        initMagics(ROOK_MAGICS, rookTable.data(), rookRayAttacks);
+        initMagics(BISHOP_MAGICS, bishopTable.data(), bishopRayAttacks);
+    }
+} magicInit;
+} // namespace
+} // namespace Bitboard
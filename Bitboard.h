@@ -0,0 +1,249 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "Types.h"
+#include <array>
+#include <bit>
+
+// With BMI2 (e.g. -march=native on a recent CPU) sliding attacks are looked up
+// with PEXT; otherwise we fall back to plain magic multiplication.
+#if defined(__BMI2__)
+#include <immintrin.h>
+#define BITBOARD_USE_PEXT 1
+#endif
+
+// Bitboards hold one bit per tile, so they only work for a standard board.
+static_assert(GRID_LENGTH == 8, "bitboards require an 8x8 grid");
+
+// Helpers and precomputed tables for 64-bit piece sets.
+// Tile (column, row) is stored in bit (row * 8 + column), so iterating the set
+// bits from lowest to highest visits tiles in the same order as looping over
+// rows and then columns.
+namespace Bitboard {
+// Returns the index (0-63) of the tile at the specified column and row.
+constexpr auto square(u8 column, u8 row) -> u8 {
+    return row * GRID_LENGTH + column;
+}
+
+// Returns the column of the tile at the specified index.
+constexpr auto column(u8 square) -> u8 { return square % GRID_LENGTH; }
+
+// Returns the row of the tile at the specified index.
+constexpr auto row(u8 square) -> u8 { return square / GRID_LENGTH; }
+
+// Returns a set with only the specified tile.
+constexpr auto bit(u8 square) -> u64 { return u64{1} << square; }
+
+// Returns the number of tiles in the set.
+constexpr auto count(u64 set) -> int { return std::popcount(set); }
+
+// Returns the lowest tile in the set. The set must not be empty.
+constexpr auto first(u64 set) -> u8 { return std::countr_zero(set); }
+
+// Returns the highest tile in the set. The set must not be empty.
+constexpr auto last(u64 set) -> u8 { return 63 - std::countl_zero(set); }
+
+// Removes the lowest tile from the set and returns it.
+constexpr auto popFirst(u64 &set) -> u8 {
+    const u8 square = first(set);
+    set &= set - 1;
+    return square;
+}
+
+// Returns the n-th lowest tile in the set, counting from 0. The set must have
+// more than n tiles.
+inline auto nth(u64 set, int n) -> u8 {
+#ifdef BITBOARD_USE_PEXT
+    return first(_pdep_u64(u64{1} << n, set));
+#else
+    for (; n > 0; --n)
+        set &= set - 1;
+    return first(set);
+#endif
+}
+
+// Index into per-colour tables (BLACK = 0, WHITE = 1).
+constexpr auto colorIndex(u8 color) -> u8 { return (color & COLOR_MASK) >> 3; }
+
+// Rows of the board as sets.
+constexpr u64 ROW_0 = 0xFFULL;
+constexpr u64 ROW_7 = ROW_0 << 56;
+
+// White tiles (see Board::colorAt), and the rest are black.
+constexpr u64 WHITE_TILES = 0x55AA55AA55AA55AAULL;
+
+// The eight directions a piece can slide in. Directions with a positive
+// index delta are listed first, so (dir < 4) means walking up the bits.
+enum Direction {
+    NORTH,
+    EAST,
+    NORTH_EAST,
+    NORTH_WEST,
+    SOUTH,
+    WEST,
+    SOUTH_WEST,
+    SOUTH_EAST,
+};
+
+namespace detail {
+constexpr int DIRECTION_COLUMNS[8] = {0, 1, 1, -1, 0, -1, -1, 1};
+constexpr int DIRECTION_ROWS[8] = {1, 0, 1, 1, -1, 0, -1, -1};
+
+// Builds a table of single step targets, e.g. for knights or kings.
+template <std::size_t N>
+constexpr auto stepTable(const int (&columns)[N], const int (&rows)[N])
+    -> std::array<u64, 64> {
+    std::array<u64, 64> table{};
+    for (int sq = 0; sq < 64; ++sq)
+        for (std::size_t i = 0; i < N; ++i) {
+            const int c = sq % 8 + columns[i];
+            const int r = sq / 8 + rows[i];
+            if (c >= 0 && c < 8 && r >= 0 && r < 8)
+                table[sq] |= u64{1} << (r * 8 + c);
+        }
+    return table;
+}
+
+constexpr int KNIGHT_COLUMNS[8] = {-2, -2, -1, -1, 1, 1, 2, 2};
+constexpr int KNIGHT_ROWS[8] = {-1, 1, -2, 2, -2, 2, -1, 1};
+constexpr int KING_COLUMNS[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+constexpr int KING_ROWS[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+constexpr int WHITE_PAWN_COLUMNS[2] = {-1, 1};
+constexpr int WHITE_PAWN_ROWS[2] = {1, 1};
+constexpr int BLACK_PAWN_COLUMNS[2] = {-1, 1};
+constexpr int BLACK_PAWN_ROWS[2] = {-1, -1};
+
+// Builds the table of every tile beyond each tile in each direction, up to
+// the edge of the board.
+constexpr auto rayTable() -> std::array<std::array<u64, 64>, 8> {
+    std::array<std::array<u64, 64>, 8> table{};
+    for (int dir = 0; dir < 8; ++dir)
+        for (int sq = 0; sq < 64; ++sq)
+            for (int c = sq % 8 + DIRECTION_COLUMNS[dir],
+                     r = sq / 8 + DIRECTION_ROWS[dir];
+                 c >= 0 && c < 8 && r >= 0 && r < 8;
+                 c += DIRECTION_COLUMNS[dir], r += DIRECTION_ROWS[dir])
+                table[dir][sq] |= u64{1} << (r * 8 + c);
+    return table;
+}
+} // namespace detail
+
+// Tiles a knight on each tile attacks.
+inline constexpr std::array<u64, 64> KNIGHT_ATTACKS =
+    detail::stepTable(detail::KNIGHT_COLUMNS, detail::KNIGHT_ROWS);
+
+// Tiles a king on each tile attacks.
+inline constexpr std::array<u64, 64> KING_ATTACKS =
+    detail::stepTable(detail::KING_COLUMNS, detail::KING_ROWS);
+
+// Tiles a pawn on each tile attacks, indexed by colorIndex() first.
+inline constexpr std::array<std::array<u64, 64>, 2> PAWN_ATTACKS = {
+    detail::stepTable(detail::BLACK_PAWN_COLUMNS, detail::BLACK_PAWN_ROWS),
+    detail::stepTable(detail::WHITE_PAWN_COLUMNS, detail::WHITE_PAWN_ROWS)};
+
+// Every tile beyond each tile in each direction, indexed by direction first.
+inline constexpr std::array<std::array<u64, 64>, 8> RAYS = detail::rayTable();
+
+namespace detail {
+// Builds the tables of tiles between and through each pair of tiles that
+// share a row, column or diagonal. Pairs that don't share one are left empty.
+using PairTable = std::array<std::array<u64, 64>, 64>;
+
+constexpr auto pairTables() -> std::array<PairTable, 2> {
+    std::array<PairTable, 2> tables{};
+    for (int from = 0; from < 64; ++from)
+        for (int dir = 0; dir < 8; ++dir) {
+            const int opposite = (dir + 4) % 8;
+            const u64 line = RAYS[dir][from] | RAYS[opposite][from] |
+                             (u64{1} << from);
+            for (u64 ray = RAYS[dir][from]; ray; ray &= ray - 1) {
+                const int to = std::countr_zero(ray);
+                tables[0][from][to] =
+                    RAYS[dir][from] & ~RAYS[dir][to] & ~(u64{1} << to);
+                tables[1][from][to] = line;
+            }
+        }
+    return tables;
+}
+
+inline constexpr auto PAIR_TABLES = pairTables();
+} // namespace detail
+
+// Tiles strictly between two tiles, e.g. where a check can be blocked.
+inline constexpr const detail::PairTable &BETWEEN =
+    detail::PAIR_TABLES[0];
+
+// Every tile on the line through two tiles, from edge to edge. A pinned piece
+// can only move along the line through it and its king.
+inline constexpr const detail::PairTable &LINE =
+    detail::PAIR_TABLES[1];
+
+// Returns the tiles a slider on the tile attacks in one direction, stopping
+// at (and including) the first occupied tile.
+constexpr auto rayAttacks(Direction dir, u8 square, u64 occupied) -> u64 {
+    const u64 ray = RAYS[dir][square];
+    const u64 blockers = ray & occupied;
+    if (!blockers)
+        return ray;
+    const u8 blocker = dir < SOUTH ? first(blockers) : last(blockers);
+    return ray ^ RAYS[dir][blocker];
+}
+
+// Returns the tiles a rook on the tile attacks given the occupied tiles, by
+// walking each ray. Slow; used to build the lookup tables.
+constexpr auto rookRayAttacks(u8 square, u64 occupied) -> u64 {
+    return rayAttacks(NORTH, square, occupied) |
+           rayAttacks(EAST, square, occupied) |
+           rayAttacks(SOUTH, square, occupied) |
+           rayAttacks(WEST, square, occupied);
+}
+
+// Same as above, but for a bishop.
+constexpr auto bishopRayAttacks(u8 square, u64 occupied) -> u64 {
+    return rayAttacks(NORTH_EAST, square, occupied) |
+           rayAttacks(NORTH_WEST, square, occupied) |
+           rayAttacks(SOUTH_WEST, square, occupied) |
+           rayAttacks(SOUTH_EAST, square, occupied);
+}
+
+// Sliding attack lookup for a single tile. The occupied tiles that can block
+// the slider (mask) are hashed into an index in the attacks table, either
+// with PEXT or by multiplying with a magic number.
+struct Magic {
+    u64 mask = 0U;
+    u64 magic = 0U;
+    u64 *attacks = nullptr;
+    u8 shift = 0U;
+
+    auto index(u64 occupied) const -> u32 {
+#if defined(BITBOARD_USE_PEXT)
+        return _pext_u64(occupied, mask);
+#else
+        return ((occupied & mask) * magic) >> shift;
+#endif
+    }
+};
+
+// Lookups for every tile, filled in once at startup (see Bitboard.cc).
+extern std::array<Magic, 64> ROOK_MAGICS;
+extern std::array<Magic, 64> BISHOP_MAGICS;
+
+// Returns the tiles a rook on the tile attacks given the occupied tiles.
+inline auto rookAttacks(u8 square, u64 occupied) -> u64 {
+    const Magic &m = ROOK_MAGICS[square];
+    return m.attacks[m.index(occupied)];
+}
+
+// Returns the tiles a bishop on the tile attacks given the occupied tiles.
+inline auto bishopAttacks(u8 square, u64 occupied) -> u64 {
+    const Magic &m = BISHOP_MAGICS[square];
+    return m.attacks[m.index(occupied)];
+}
+
+// Returns the tiles a queen on the tile attacks given the occupied tiles.
+inline auto queenAttacks(u8 square, u64 occupied) -> u64 {
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+} // namespace Bitboard
+
+#endif
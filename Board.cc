@@ -1,15 +1,48 @@
 #include "Board.h"
-
-Board::Board() : m_pieces{} {}
-
-Board::Board(const Board &other) : m_pieces{} {
+#include "MoveGenerator.h"
+#include <algorithm>
+
+namespace {
+// Returns the material signature (see Board::m_material) of one piece.
+constexpr auto material(u8 piece) -> u64 { return u64{1} << (piece * 4); }
+
+// Material signatures, not counting kings, where neither player can
+// checkmate. Kings alone, or a king and a single bishop or knight.
+constexpr std::array<u64, 5> INSUFFICIENT_MATERIAL = {
+    0U,
+    material(BISHOP | WHITE),
+    material(BISHOP | BLACK),
+    material(KNIGHT | WHITE),
+    material(KNIGHT | BLACK),
+};
+
+// Piece values for static exchange evaluation (pawn = 100), indexed by type.
+// ROOK and CASTLE are both rooks.
+constexpr std::array<int, 8> SEE_VALUES = {0, 100, 300, 300, 900, 20000, 500,
+                                           500};
+
+// Types in order of value, for finding the least valuable attacker.
+constexpr std::array<u8, 7> TYPES_BY_VALUE = {PAWN, KNIGHT, BISHOP, ROOK,
+                                              CASTLE, QUEEN, KING};
+} // namespace
+
+Board::Board() : m_pieces{}, m_bitboards{}, m_occupied{} {}
+
+Board::Board(const Board &other)
+    : m_pieces{}, m_bitboards{other.m_bitboards}, m_occupied{other.m_occupied} {
     m_pieces = other.m_pieces;
     m_bits = other.m_bits;
+    m_hash = other.m_hash;
+    m_material = other.m_material;
 }
 
 auto Board::reset() -> void {
     m_pieces.fill(0);
+    m_bitboards.fill(0);
+    m_occupied.fill(0);
     m_bits = 0;
+    m_hash = 0;
+    m_material = 0;
 }
 
 auto Board::pieceAt(u8 column, u8 row) const -> u8 {
@@ -25,7 +58,30 @@ auto Board::colorAt(u8 column, u8 row) const -> u8 {
     return (column + row) & 1 ? WHITE : BLACK;
 }
 
+auto Board::pieces(u8 color) const -> u64 {
+    return m_occupied[Bitboard::colorIndex(color)];
+}
+
+auto Board::tiles(u8 piece) const -> u64 { return m_bitboards[piece]; }
+
+auto Board::count(u8 piece) const -> u8 {
+    return (m_material >> (piece * 4)) & PIECE_MASK;
+}
+
+auto Board::kingSquare(u8 color) const -> u8 {
+    const u64 king = m_bitboards[KING | color];
+    return king ? Bitboard::first(king) : 64U;
+}
+
 auto Board::setPiece(u8 piece, u8 column, u8 row) -> void {
+    // Take whatever was on this tile off the bitboards first.
+    removePiece(column, row);
+    const u64 tile = Bitboard::bit(Bitboard::square(column, row));
+    m_bitboards[piece] |= tile;
+    m_occupied[Bitboard::colorIndex(piece)] |= tile;
+    m_hash ^= Zobrist::KEYS.pieces[piece][Bitboard::square(column, row)];
+    m_material += material(piece);
+
     // If piece is a black pawn (1) at column 2, then shift 0b0001 left by 2
     // * 4 = 8. Mask then arrives at 0b000100000000.
     u32 mask = PIECE_MASK << (column * 4);
@@ -37,6 +93,15 @@ auto Board::setPiece(u8 piece, u8 column, u8 row) -> void {
 }
 
 auto Board::removePiece(u8 column, u8 row) -> void {
+    const u8 piece = pieceAt(column, row);
+    if (piece != EMPTY) {
+        const u64 tile = Bitboard::bit(Bitboard::square(column, row));
+        m_bitboards[piece] &= ~tile;
+        m_occupied[Bitboard::colorIndex(piece)] &= ~tile;
+        m_hash ^= Zobrist::KEYS.pieces[piece][Bitboard::square(column, row)];
+        m_material -= material(piece);
+    }
+
     // Mask is set to PIECE_MASK (0b1111) shifted by column * 4. So if
     // column = 2 then mask = 0b111100000000.
     const u32 mask = PIECE_MASK << (column * 4);
@@ -94,7 +159,7 @@ auto Board::isEnPassant(const Move &move) const -> bool {
     if (!(m_bits & DOUBLE_MASK))
         return false;
 
-    const u8 column = m_bits & PAWN_MASK;
+    const u8 column = (m_bits & PAWN_MASK) >> 2;
     const u8 piece = pieceAt(move.fromCol, move.fromRow);
 
     // Moving piece must be a pawn
@@ -182,15 +247,16 @@ auto Board::isMoveLegalForPiece(u8 piece, const Move &move) -> bool {
             const u8 castleColumn = dir == -1 ? 0 : 7;
             const u8 castle = pieceAt(castleColumn, move.fromRow);
 
-            if ((castle & TYPE_MASK) != CASTLE)
+            if (castle != (CASTLE | (piece & COLOR_MASK)))
                 return false;
 
             // Cannot move from, through or into check (but into
             // check will be covered elsewhere, so we only need to
-            // check from and through)
+            // check from and through). The tile we move through is
+            // empty, so ask whether our king would be attacked there.
             if (isAttacked(move.fromCol, move.fromRow))
                 return false;
-            else if (isAttacked(move.fromCol + dir, move.toRow))
+            else if (isAttacked(move.fromCol + dir, move.toRow, piece))
                 return false;
 
             // Finally, all tiles between the king and the rook must
@@ -295,7 +361,7 @@ auto Board::doMove(const Move &move) -> bool {
     // Check if the move is legal and then do it if it is.
     bool moveLegal = isMoveLegal(move);
     if (moveLegal)
-        forceDoMove(move);
+        makeMove(move);
     return moveLegal;
 }
 
@@ -312,47 +378,60 @@ auto Board::getBoardState(uint16_t staleHalfMoveClock) -> BoardState {
     else if (staleHalfMoveClock >= 100U) {
         return STATE_FORCED_DRAW_FIFTY_MOVES;
     }
-    // check all piece types on the board (except king)
-    // if we only have kings, or king v king + bishop or king v king +
-    // knight then it's a forced draw
-    u8 numPieces = 0U;
-    struct {
-        u8 type;
-        u8 color;
-        u8 tileColor;
-    } alivePiece[2];
-
-    for (u8 i = 0; i < GRID_LENGTH * GRID_LENGTH && numPieces <= 1; ++i) {
-        const u8 row = i / GRID_LENGTH;
-        const u8 column = i % GRID_LENGTH;
-        const u8 piece = pieceAt(column, row);
-        if ((piece & TYPE_MASK) != KING) {
-            alivePiece[numPieces++] = {(u8)(piece & TYPE_MASK),
-                                       (u8)(piece & COLOR_MASK),
-                                       colorAt(column, row)};
-        }
-    }
-    // no pieces but kings, or one piece and it's a knight/bishop
-    if (numPieces == 0 || (numPieces == 1 && (alivePiece[0].type == KNIGHT ||
-                                              alivePiece[0].type == BISHOP)))
+    else if (hasInsufficientMaterial()) {
         return STATE_FORCED_DRAW_INSUFFICIENT_MATERIAL;
-    // two pieces, and both bishops of same color
-    else if (numPieces == 2) {
-        bool isBothBishop =
-            alivePiece[0].type == BISHOP && alivePiece[1].type == BISHOP;
-        bool isOppositePlayer = alivePiece[0].color != alivePiece[1].color;
-        bool isSameTile = alivePiece[0].tileColor == alivePiece[1].tileColor;
-        if (isBothBishop && isOppositePlayer && isSameTile)
-            return STATE_FORCED_DRAW_INSUFFICIENT_MATERIAL;
     }
     // else normal
     return STATE_NORMAL;
 }
 
-auto Board::forceDoMove(const Move &move) -> void {
+auto Board::hasInsufficientMaterial() const -> bool {
+    // look up the pieces on the board (except kings); if we only have
+    // kings, or king v king + bishop or king v king + knight then it's a
+    // forced draw
+    const u64 signature =
+        m_material & ~(material(KING | WHITE) * PIECE_MASK) &
+        ~(material(KING | BLACK) * PIECE_MASK);
+    if (std::find(INSUFFICIENT_MATERIAL.begin(), INSUFFICIENT_MATERIAL.end(),
+                  signature) != INSUFFICIENT_MATERIAL.end())
+        return true;
+    // two pieces, and both bishops of opposite players on the same colour
+    // of tile
+    if (signature == (material(BISHOP | WHITE) | material(BISHOP | BLACK))) {
+        const u64 bishops =
+            m_bitboards[BISHOP | WHITE] | m_bitboards[BISHOP | BLACK];
+        return !(bishops & Bitboard::WHITE_TILES) ||
+               !(bishops & ~Bitboard::WHITE_TILES);
+    }
+    return false;
+}
+
+auto Board::materialValue(u8 color) const -> int {
+    int value = 0;
+    for (u8 type : {PAWN, BISHOP, KNIGHT, QUEEN, ROOK, CASTLE})
+        value += SEE_VALUES[type] * Bitboard::count(m_bitboards[type | color]);
+    return value;
+}
+
+auto Board::makeMove(const Move &move) -> Undo {
     const u8 mycolor = whiteMove() ? WHITE : BLACK;
     u8 src = pieceAt(move.fromCol, move.fromRow);
 
+    Undo undo;
+    undo.move = move;
+    undo.piece = src;
+    undo.bits = m_bits;
+    undo.hash = m_hash;
+    undo.castles = m_bitboards[CASTLE | WHITE] | m_bitboards[CASTLE | BLACK];
+    // En passant captures the pawn that just moved past us, which is on our
+    // source row.
+    undo.capturedRow = isEnPassant(move) ? move.fromRow : move.toRow;
+    undo.captured = pieceAt(move.toCol, undo.capturedRow);
+
+    // Any en passant chance is gone after this move, unless it's another
+    // double pawn move.
+    m_bits &= (~(PAWN_MASK | DOUBLE_MASK));
+
     if ((src & TYPE_MASK) == CASTLE) // Moving rook for first time
         src = ROOK | mycolor;
 
@@ -366,13 +445,12 @@ auto Board::forceDoMove(const Move &move) -> void {
 
             removePiece(rookSourceCol, row);
             setPiece(ROOK | mycolor, rookTargetCol, row);
-        } else // king moving, but not a castle
-        {
-            const u8 row = mycolor == WHITE ? 0 : 7;
-            for (u8 col : {0, 7})
-                if (pieceAt(col, row) == (CASTLE | mycolor))
-                    setPiece(ROOK | mycolor, col, row);
         }
+        // king has moved, so can't castle with either rook any more
+        const u8 row = mycolor == WHITE ? 0 : 7;
+        for (u8 col : {0, 7})
+            if (pieceAt(col, row) == (CASTLE | mycolor))
+                setPiece(ROOK | mycolor, col, row);
     }
     // Do promotion
     else if ((src & TYPE_MASK) == PAWN) {
@@ -380,175 +458,370 @@ auto Board::forceDoMove(const Move &move) -> void {
         if ((move.fromRow == 1 && move.toRow == 3) ||
             (move.fromRow == 6 && move.toRow == 4)) {
             m_bits |= DOUBLE_MASK;
-            m_bits &= (~PAWN_MASK);
             m_bits |= (move.fromCol << 2);
         }
         // promotion
         else if (move.promotion) {
             src = (move.promotion & TYPE_MASK) | (src & COLOR_MASK);
         }
-    } else {
-        m_bits &= (~(PAWN_MASK | DOUBLE_MASK));
     }
 
-    if ((src & TYPE_MASK) == PAWN || pieceAt(move.toCol, move.toRow) != EMPTY) {
+    if ((undo.piece & TYPE_MASK) == PAWN || undo.captured != EMPTY) {
         // Pawn move or capture - clear stale mask
         m_bits &= (~STALE_MASK);
     } else {
         m_bits |= STALE_MASK;
     }
 
+    if (undo.captured != EMPTY)
+        removePiece(move.toCol, undo.capturedRow);
     setPiece(src, move.toCol, move.toRow);
     removePiece(move.fromCol, move.fromRow);
 
     // Flip whose turn it is
     m_bits ^= BLACKMOVE_MASK;
+    m_hash ^= Zobrist::stateKey(undo.bits) ^ Zobrist::stateKey(m_bits);
+    return undo;
+}
+
+auto Board::unmakeMove(const Undo &undo) -> void {
+    const Move &move = undo.move;
+
+    // Put the moving and captured pieces back
+    removePiece(move.toCol, move.toRow);
+    setPiece(undo.piece, move.fromCol, move.fromRow);
+    if (undo.captured != EMPTY)
+        setPiece(undo.captured, move.toCol, undo.capturedRow);
+
+    // Put the rook back if we castled
+    if ((undo.piece & TYPE_MASK) == KING && move.fromCol == 4 &&
+        (move.toCol == 6 || move.toCol == 2)) {
+        const bool kingSide = move.toCol == 6;
+        removePiece(kingSide ? 5 : 3, move.fromRow);
+        setPiece(ROOK | (undo.piece & COLOR_MASK), kingSide ? 7 : 0,
+                 move.fromRow);
+    }
+
+    // Any rooks that lost their castling rights become unmoved again
+    u64 castles = undo.castles &
+                  ~(m_bitboards[CASTLE | WHITE] | m_bitboards[CASTLE | BLACK]);
+    while (castles) {
+        const u8 square = Bitboard::popFirst(castles);
+        const u8 column = Bitboard::column(square);
+        const u8 row = Bitboard::row(square);
+        setPiece(CASTLE | (pieceAt(column, row) & COLOR_MASK), column, row);
+    }
+
+    m_bits = undo.bits;
+    m_hash = undo.hash;
 }
 
 auto Board::hasZeroMoves() -> bool {
-    auto moves = getMoves(1);
-    return moves.empty();
+    Move move;
+    MoveGenerator generator(*this);
+    return !generator.next(move);
 }
 
 auto Board::hasOneMove() -> bool {
-    auto moves = getMoves(2);
-    return moves.size() == 1;
+    Move move;
+    MoveGenerator generator(*this);
+    return generator.next(move) && !generator.next(move);
+}
+
+auto Board::getTargets(u8 piece, u8 square) const -> u64 {
+    const u8 color = piece & COLOR_MASK;
+    const u8 enemy = color == WHITE ? BLACK : WHITE;
+    const u64 own = m_occupied[Bitboard::colorIndex(color)];
+    const u64 theirs = m_occupied[Bitboard::colorIndex(enemy)];
+    const u64 occupied = own | theirs;
+    // We can't capture our own pieces, and the King can never be captured.
+    const u64 blocked = own | m_bitboards[KING | enemy];
+
+    switch (piece & TYPE_MASK) {
+    case BISHOP:
+        return Bitboard::bishopAttacks(square, occupied) & ~blocked;
+    case KING:
+        return Bitboard::KING_ATTACKS[square] & ~blocked;
+    case KNIGHT:
+        return Bitboard::KNIGHT_ATTACKS[square] & ~blocked;
+    case PAWN: {
+        // Pawns only move diagonally when capturing, and can only move two
+        // tiles from their initial row if both tiles are empty.
+        u64 targets =
+            Bitboard::PAWN_ATTACKS[Bitboard::colorIndex(color)][square] &
+            theirs;
+        const u64 tile = Bitboard::bit(square);
+        const u64 single = color == WHITE ? tile << 8 : tile >> 8;
+        if (single & ~occupied) {
+            targets |= single;
+            const u8 initialRow = color == WHITE ? 1 : 6;
+            const u64 dbl = color == WHITE ? single << 8 : single >> 8;
+            if (Bitboard::row(square) == initialRow && (dbl & ~occupied))
+                targets |= dbl;
+        }
+        return targets & ~blocked;
+    }
+    case QUEEN:
+        return Bitboard::queenAttacks(square, occupied) & ~blocked;
+    case ROOK:
+    case CASTLE:
+        return Bitboard::rookAttacks(square, occupied) & ~blocked;
+    default:
+        return 0;
+    }
 }
 
 auto Board::getMoves(u8 count) -> std::vector<Move> {
+    MoveList moves;
+    getMoves(moves, count);
+    return {moves.begin(), moves.end()};
+}
+
+auto Board::getMoves(MoveList &moves, u8 count) -> void {
     const u8 mycolor = whiteMove() ? WHITE : BLACK;
-    std::vector<Move> moves;
-
-    // Loop over all squares and find our pieces.
-    for (u8 row = 0; row < GRID_LENGTH; ++row)
-        for (u8 column = 0; column < GRID_LENGTH; ++column) {
-            // Adds a move but only if it is legal.
-            // Required because for loops below will try to add lots
-            // of out-of-bounds and weird, illegal moves.
-            auto tryAddMove = [&column, &row, &moves, this](u8 toCol, u8 toRow,
-                                                            u8 promote = 0U) {
-                const Move move{column, toCol, row, toRow, promote};
-                if (isMoveLegal(move))
-                    moves.push_back(move);
-            };
-
-            const u8 piece = pieceAt(column, row);
-            if ((piece & COLOR_MASK) == mycolor) {
-                switch (piece & TYPE_MASK) {
-                case BISHOP: {
-                    // Check all diagonal vectors
-                    for (int c : {-1, 1})
-                        for (int r : {-1, 1})
-                            for (int col = column + c, rw = row + r;
-                                 inBounds(col, rw); col += c, rw += r)
-                                tryAddMove(col, rw);
-                    break;
-                }
-                case KING: {
-                    // For King, we just need to try and
-                    // move to all 8 surrounding tiles
-                    for (int c : {-1, 0, 1})
-                        for (int r : {-1, 0, 1})
-                            tryAddMove(column + c, row + r);
-                    // Try adding castling moves
-                    tryAddMove(column - 2, row);
-                    tryAddMove(column + 2, row);
-                    break;
-                }
-                case KNIGHT: {
-                    // For knight, try all pieces that are
-                    // delta row = 2 and delta column = 1 or
-                    // delta row = 1 and delta column = 2.
-                    for (int c : {-2, -1, 1, 2})
-                        for (int r : {-2, -1, 1, 2})
-                            if (std::abs(c) != std::abs(r))
-                                tryAddMove(column + c, row + r);
-                    break;
-                }
-                case PAWN: {
-                    // All possible pawn moves; +1 row, +2
-                    // rows, +1 row +1 column (for capture).
-                    u8 color = piece & COLOR_MASK;
-                    for (int dc : {-1, 0, 1})
-                        for (int dr : {1, 2}) {
-                            if (dc && dr == 2)
-                                continue;
-
-                            // Check for promotion
-                            const u8 newRow =
-                                (color == WHITE) ? row + dr : row - dr;
-                            const bool isPromote =
-                                (newRow == GRID_LENGTH - 1) ||
-                                newRow == 0; // Black
-                                             // pawns
-                                             // can't ever
-                                             // get to
-                                             // rank 8 and
-                                             // white
-                                             // pawns
-                                             // can't get
-                                             // to rank 0
-                            if (isPromote) {
-                                for (u8 type : {QUEEN, KNIGHT, ROOK, BISHOP})
-                                    tryAddMove(column + dc, newRow, type);
-                            } else {
-                                tryAddMove(column + dc, newRow);
-                            }
-                        }
-                    break;
-                }
-                case QUEEN: {
-                    // Queen, we need to check all diagnoal
-                    // vectors + the horizontal and vertical
-                    // axis
-                    for (int c : {-1, 0, 1})
-                        for (int r : {-1, 0, 1})
-                            if (c || r)
-                                for (int col = column + c, rw = row + r;
-                                     inBounds(col, rw); col += c, rw += r)
-                                    tryAddMove(col, rw);
-                    break;
-                }
-                case ROOK:
-                case CASTLE: {
-                    // Try horizontal and vertical vectors.
-                    for (int mult : {-1, 1}) {
-                        for (int col = column + mult; inBounds(col, row);
-                             col += mult)
-                            tryAddMove(col, row);
-                        for (int rw = row + mult; inBounds(column, rw);
-                             rw += mult)
-                            tryAddMove(column, rw);
-                    }
-                    break;
-                }
-                }
-                // Break out if we've hit the move limit.
-                if (count && moves.size() >= count) {
-                    return moves;
-                }
+    const CheckInfo info = getCheckInfo();
+    moves.clear();
+
+    // Loop over our pieces, in the same order as scanning rows and then
+    // columns.
+    u64 pieces = m_occupied[Bitboard::colorIndex(mycolor)];
+    while (pieces) {
+        addMoves(moves, Bitboard::popFirst(pieces), info, ALL_MOVES);
+
+        // Break out if we've hit the move limit.
+        if (count && moves.size() >= count)
+            return;
+    }
+}
+
+auto Board::addMoves(MoveList &moves, u8 from, const CheckInfo &info,
+                     u8 kinds) -> void {
+    const u8 column = Bitboard::column(from);
+    const u8 row = Bitboard::row(from);
+    const u8 piece = pieceAt(column, row);
+    const u8 type = piece & TYPE_MASK;
+    const u8 enemy = (piece & COLOR_MASK) == WHITE ? BLACK : WHITE;
+    const u64 theirs = m_occupied[Bitboard::colorIndex(enemy)];
+
+    // Pawn moves onto the last rows are promotions, unless they capture.
+    const u64 promotions =
+        type == PAWN ? Bitboard::ROW_0 | Bitboard::ROW_7 : 0U;
+    u64 mask = 0U;
+    if (kinds & CAPTURE_MOVES)
+        mask |= theirs;
+    if (kinds & PROMOTION_MOVES)
+        mask |= promotions & ~theirs;
+    if (kinds & QUIET_MOVES)
+        mask |= ~(theirs | promotions);
+
+    u64 targets = getLegalTargets(piece, from, info) & mask;
+    while (targets) {
+        const u8 to = Bitboard::popFirst(targets);
+        Move move{column, Bitboard::column(to), row, Bitboard::row(to)};
+        if (Bitboard::bit(to) & promotions) {
+            for (u8 promote : {QUEEN, KNIGHT, ROOK, BISHOP}) {
+                move.promotion = promote;
+                moves.push_back(move);
             }
+        } else {
+            moves.push_back(move);
         }
-    return moves;
+    }
+
+    // Castling and en passant are special, and neither are promotions.
+    const u8 special = type == KING ? QUIET_MOVES : CAPTURE_MOVES;
+    if (kinds & special) {
+        targets = getSpecialTargets(piece, from);
+        while (targets) {
+            const u8 to = Bitboard::popFirst(targets);
+            moves.push_back({column, Bitboard::column(to), row,
+                             Bitboard::row(to)});
+        }
+    }
 }
 
-auto Board::isCheck(u8 color) -> bool {
-    const u8 myKing = KING | color;
-    // Find king.
-    for (u8 row = 0; row < GRID_LENGTH; ++row)
-        for (u8 column = 0; column < GRID_LENGTH; ++column) {
-            if (pieceAt(column, row) == myKing) {
-                // Return whether king is attacked. Here, we
-                // assume there can be only one king per player,
-                // which makes sense. But worth bearing in mind
-                // in case we start creating weird games/puzzles
-                // with multiple kings.
-                return isAttacked(column, row);
-                // For multiple kings:
-                // if (isAttacked (column, row)) return true;
+auto Board::getSpecialTargets(u8 piece, u8 square) -> u64 {
+    const u8 column = Bitboard::column(square);
+    const u8 row = Bitboard::row(square);
+    const u8 mycolor = piece & COLOR_MASK;
+    u64 targets = 0U;
+
+    // Castling and en passant are rare, so leave those to isMoveLegal,
+    // which tries them on the board.
+    if ((piece & TYPE_MASK) == KING) {
+        for (int dc : {-2, 2}) {
+            const Move move{column, (u8)(column + dc), row, row};
+            if (isMoveLegal(move))
+                targets |= Bitboard::bit(Bitboard::square(move.toCol, row));
+        }
+    } else if ((piece & TYPE_MASK) == PAWN && (m_bits & DOUBLE_MASK)) {
+        // En passant is a diagonal move onto an empty tile.
+        u64 captures =
+            Bitboard::PAWN_ATTACKS[Bitboard::colorIndex(mycolor)][square] &
+            ~(m_occupied[0] | m_occupied[1]);
+        while (captures) {
+            const u8 to = Bitboard::popFirst(captures);
+            const Move move{column, Bitboard::column(to), row,
+                            Bitboard::row(to)};
+            if (isMoveLegal(move))
+                targets |= Bitboard::bit(to);
+        }
+    }
+    return targets;
+}
+
+auto Board::countMoves() -> u32 {
+    const u8 mycolor = whiteMove() ? WHITE : BLACK;
+    const CheckInfo info = getCheckInfo();
+    u32 count = 0U;
+
+    u64 pieces = m_occupied[Bitboard::colorIndex(mycolor)];
+    while (pieces) {
+        const u8 from = Bitboard::popFirst(pieces);
+        const u8 piece = pieceAt(Bitboard::column(from), Bitboard::row(from));
+        const u64 targets = getLegalTargets(piece, from, info);
+        count += Bitboard::count(targets);
+
+        // Each promotion is four moves; one for each piece we can promote to
+        if ((piece & TYPE_MASK) == PAWN)
+            count += 3 * Bitboard::count(targets & (Bitboard::ROW_0 |
+                                                    Bitboard::ROW_7));
+        if ((piece & TYPE_MASK) == KING || (m_bits & DOUBLE_MASK))
+            count += Bitboard::count(getSpecialTargets(piece, from));
+    }
+    return count;
+}
+
+auto Board::countMoves(u8 color) -> u32 {
+    if ((color == WHITE) == whiteMove())
+        return countMoves();
+    // Only the turn (and en passant, which was the other player's) needs
+    // to change, and counting doesn't look at the hash, so just swap the
+    // bits for the count rather than making a null move.
+    const u8 bits = m_bits;
+    m_bits = (m_bits ^ BLACKMOVE_MASK) & ~(PAWN_MASK | DOUBLE_MASK);
+    const u32 count = countMoves();
+    m_bits = bits;
+    return count;
+}
+
+auto Board::randomMove(Random &random, Move &move) -> bool {
+    const u8 mycolor = whiteMove() ? WHITE : BLACK;
+    const u8 enemy = whiteMove() ? BLACK : WHITE;
+    const CheckInfo info = getCheckInfo();
+    const u64 occupied = m_occupied[0] | m_occupied[1];
+    const u64 promotions = Bitboard::ROW_0 | Bitboard::ROW_7;
+    const u64 enPassant =
+        (m_bits & DOUBLE_MASK)
+            ? Bitboard::bit(Bitboard::square(enPassantColumn(),
+                                             mycolor == WHITE ? 5 : 2))
+            : 0U;
+
+    // Collect the tiles each piece might move to. Pins and checks are taken
+    // care of by getLegalTargets(), so these are all legal, except for the
+    // king's (which may walk into check), castling and en passant.
+    std::array<u8, 64> froms;
+    std::array<u64, 64> targets;
+    std::array<u32, 64> counts;
+    std::size_t pieceCount = 0U;
+    u32 total = 0U;
+    for (u64 pieces = m_occupied[Bitboard::colorIndex(mycolor)]; pieces;) {
+        const u8 from = Bitboard::popFirst(pieces);
+        const u8 piece = pieceAt(Bitboard::column(from), Bitboard::row(from));
+        u64 tiles;
+        u32 count = 0U;
+        if ((piece & TYPE_MASK) == KING) {
+            tiles = getTargets(piece, from);
+            const u8 column = Bitboard::column(from);
+            if (column >= 2 && canCastle(mycolor, true))
+                tiles |= Bitboard::bit(from - 2);
+            if (column < 6 && canCastle(mycolor, false))
+                tiles |= Bitboard::bit(from + 2);
+        } else {
+            tiles = getLegalTargets(piece, from, info);
+            if ((piece & TYPE_MASK) == PAWN) {
+                tiles |= Bitboard::PAWN_ATTACKS[Bitboard::colorIndex(
+                             mycolor)][from] &
+                         enPassant;
+                // Each promotion is four moves.
+                count = 3 * Bitboard::count(tiles & promotions);
             }
         }
-    return false;
+        count += Bitboard::count(tiles);
+        if (count) {
+            froms[pieceCount] = from;
+            targets[pieceCount] = tiles;
+            counts[pieceCount++] = count;
+            total += count;
+        }
+    }
+    if (!total)
+        return false;
+
+    // Pick from all of them, and try again if the move is illegal. Each
+    // legal move is equally likely on each try, so they stay equally likely
+    // overall. If we keep missing (e.g. a king with few safe tiles), fall
+    // back to generating every move.
+    for (int tries = 0; tries < 8; ++tries) {
+        u32 index = random.below(total);
+        std::size_t i = 0U;
+        for (; index >= counts[i]; ++i)
+            index -= counts[i];
+        const u8 from = froms[i];
+        const u8 piece = pieceAt(Bitboard::column(from), Bitboard::row(from));
+        u8 to;
+        move.promotion = 0U;
+        if ((piece & TYPE_MASK) == PAWN) {
+            const u64 normal = targets[i] & ~promotions;
+            const u32 normalCount = Bitboard::count(normal);
+            if (index < normalCount)
+                to = Bitboard::nth(normal, index);
+            else {
+                index -= normalCount;
+                to = Bitboard::nth(targets[i] & promotions, index / 4);
+                constexpr std::array<u8, 4> PROMOTIONS = {QUEEN, KNIGHT, ROOK,
+                                                          BISHOP};
+                move.promotion = PROMOTIONS[index % 4];
+            }
+        } else
+            to = Bitboard::nth(targets[i], index);
+        move.fromCol = Bitboard::column(from);
+        move.fromRow = Bitboard::row(from);
+        move.toCol = Bitboard::column(to);
+        move.toRow = Bitboard::row(to);
+
+        if ((piece & TYPE_MASK) == KING) {
+            if (move.toCol == move.fromCol + 2 ||
+                move.fromCol == move.toCol + 2) {
+                if (isMoveLegal(move))
+                    return true;
+            } else if (info.king == 64U ||
+                       !attackersOf(to, enemy,
+                                    occupied & ~Bitboard::bit(from)))
+                return true;
+        } else if (Bitboard::bit(to) & enPassant) {
+            if (isMoveLegal(move))
+                return true;
+        } else
+            return true;
+    }
+
+    MoveList moves;
+    getMoves(moves);
+    if (moves.empty())
+        return false;
+    move = moves[random.below(moves.size())];
+    return true;
+}
+
+auto Board::isCheck(u8 color) -> bool {
+    // Here, we assume there can be only one king per player, which makes
+    // sense. But worth bearing in mind in case we start creating weird
+    // games/puzzles with multiple kings.
+    const u8 square = kingSquare(color);
+    if (square == 64U)
+        return false;
+    return isAttacked(Bitboard::column(square), Bitboard::row(square));
 }
 
 auto Board::whiteMove() const -> bool { return !(m_bits & BLACKMOVE_MASK); }
@@ -557,6 +830,20 @@ auto Board::enPassantColumn() const -> u8 {
     return (m_bits & DOUBLE_MASK) ? (m_bits & PAWN_MASK) >> 2 : UINT8_MAX;
 }
 
+auto Board::setWhiteMove(bool white) -> void {
+    const u8 bits = white ? m_bits & ~BLACKMOVE_MASK : m_bits | BLACKMOVE_MASK;
+    m_hash ^= Zobrist::stateKey(m_bits) ^ Zobrist::stateKey(bits);
+    m_bits = bits;
+}
+
+auto Board::setEnPassantColumn(u8 column) -> void {
+    u8 bits = m_bits & ~(PAWN_MASK | DOUBLE_MASK);
+    if (column < GRID_LENGTH)
+        bits |= DOUBLE_MASK | (column << 2);
+    m_hash ^= Zobrist::stateKey(m_bits) ^ Zobrist::stateKey(bits);
+    m_bits = bits;
+}
+
 auto Board::canCastle(u8 color, bool queenSide) -> bool {
     if (color == WHITE && !queenSide)
         return pieceAt(7, 0) == (CASTLE | color);
@@ -572,6 +859,8 @@ auto Board::canCastle(u8 color, bool queenSide) -> bool {
 
 auto Board::isStale() -> bool { return m_bits & STALE_MASK; }
 
+auto Board::hash() const -> u64 { return m_hash; }
+
 auto Board::isAttacked(u8 column, u8 row) const -> bool {
     const u8 piece = pieceAt(column, row);
     if (!piece)
@@ -605,7 +894,7 @@ auto Board::isAttacked(u8 column, u8 row, u8 piece) const -> bool {
     return false;
 #endif
 // 1750ms
-#if 1
+#if 0
     const u8 attackerColor = (piece & COLOR_MASK) == WHITE ? BLACK : WHITE;
     // First of all, check knight moves
     // All squares around the tile that are +2 rows, +2 colums. (or -ve)
@@ -673,4 +962,233 @@ auto Board::isAttacked(u8 column, u8 row, u8 piece) const -> bool {
         }
     return false;
 #endif
-}
\ No newline at end of file
+// Attack tables
+#if 1
+    const u8 attackerColor = (piece & COLOR_MASK) == WHITE ? BLACK : WHITE;
+    const u64 occupied = m_occupied[0] | m_occupied[1];
+    return attackersOf(Bitboard::square(column, row), attackerColor,
+                       occupied) != 0;
+#endif
+}
+
+auto Board::attackersOf(u8 square, u8 color, u64 occupied) const -> u64 {
+    const u8 defender = color == WHITE ? BLACK : WHITE;
+    const u64 queens = m_bitboards[QUEEN | color];
+
+    // Look from the tile outwards as each type of piece; if we can see an
+    // attacker of the same type from here, it can see us too. (Pawns are
+    // the exception, but looking as one of the defender's pawns works.)
+    return (Bitboard::KNIGHT_ATTACKS[square] & m_bitboards[KNIGHT | color]) |
+           (Bitboard::KING_ATTACKS[square] & m_bitboards[KING | color]) |
+           (Bitboard::PAWN_ATTACKS[Bitboard::colorIndex(defender)][square] &
+            m_bitboards[PAWN | color]) |
+           (Bitboard::bishopAttacks(square, occupied) &
+            (m_bitboards[BISHOP | color] | queens)) |
+           (Bitboard::rookAttacks(square, occupied) &
+            (m_bitboards[ROOK | color] | m_bitboards[CASTLE | color] |
+             queens));
+}
+
+auto Board::attacksFrom(u8 piece, u8 square, u64 occupied) const -> u64 {
+    switch (piece & TYPE_MASK) {
+    case PAWN:
+        return Bitboard::PAWN_ATTACKS[Bitboard::colorIndex(piece)][square];
+    case KNIGHT:
+        return Bitboard::KNIGHT_ATTACKS[square];
+    case KING:
+        return Bitboard::KING_ATTACKS[square];
+    case BISHOP:
+        return Bitboard::bishopAttacks(square, occupied);
+    case QUEEN:
+        return Bitboard::queenAttacks(square, occupied);
+    case ROOK:
+    case CASTLE:
+        return Bitboard::rookAttacks(square, occupied);
+    }
+    return 0U;
+}
+
+auto Board::attackMap(u8 color) const -> u64 {
+    const u64 occupied = m_occupied[0] | m_occupied[1];
+    u64 attacked = 0U;
+    for (u64 own = pieces(color); own;) {
+        const u8 square = Bitboard::popFirst(own);
+        attacked |= attacksFrom(pieceAt(Bitboard::column(square),
+                                        Bitboard::row(square)),
+                                square, occupied);
+    }
+    return attacked;
+}
+
+auto Board::attackMap(u8 color, std::array<u8, 64> &counts) const -> u64 {
+    const u64 occupied = m_occupied[0] | m_occupied[1];
+    u64 attacked = 0U;
+    counts.fill(0);
+    for (u64 own = pieces(color); own;) {
+        const u8 square = Bitboard::popFirst(own);
+        u64 targets = attacksFrom(
+            pieceAt(Bitboard::column(square), Bitboard::row(square)), square,
+            occupied);
+        attacked |= targets;
+        while (targets)
+            counts[Bitboard::popFirst(targets)]++;
+    }
+    return attacked;
+}
+
+auto Board::leastValuableAttacker(u64 attackers, u8 color, u8 &piece) const
+    -> u8 {
+    for (const u8 type : TYPES_BY_VALUE) {
+        const u64 tiles = attackers & m_bitboards[type | color];
+        if (tiles) {
+            piece = type | color;
+            return Bitboard::first(tiles);
+        }
+    }
+    return 64U;
+}
+
+auto Board::see(const Move &move) const -> int {
+    const u8 from = Bitboard::square(move.fromCol, move.fromRow);
+    const u8 to = Bitboard::square(move.toCol, move.toRow);
+    u8 color = pieceAt(move.fromCol, move.fromRow) & COLOR_MASK;
+    u64 occupied = (m_occupied[0] | m_occupied[1]) ^ Bitboard::bit(from);
+
+    // gain[i] is what the player making capture i has won, if the other
+    // player doesn't recapture.
+    std::array<int, 32> gain;
+    if (isEnPassant(move)) {
+        gain[0] = SEE_VALUES[PAWN];
+        occupied ^= Bitboard::bit(Bitboard::square(move.toCol, move.fromRow));
+    } else {
+        gain[0] = SEE_VALUES[pieceAt(move.toCol, move.toRow) & TYPE_MASK];
+    }
+    // Piece now standing on the target tile, to be captured next.
+    u8 target = pieceAt(move.fromCol, move.fromRow);
+    if (move.promotion) {
+        gain[0] += SEE_VALUES[move.promotion & TYPE_MASK] - SEE_VALUES[PAWN];
+        target = move.promotion;
+    }
+
+    int depth = 0;
+    while (depth < 31) {
+        color ^= COLOR_MASK;
+        const u64 attackers = attackersOf(to, color, occupied) & occupied;
+        u8 attacker = EMPTY;
+        const u8 square = leastValuableAttacker(attackers, color, attacker);
+        if (square == 64U)
+            break;
+        // A king can't capture a defended piece.
+        const u64 after = occupied ^ Bitboard::bit(square);
+        if ((attacker & TYPE_MASK) == KING &&
+            (attackersOf(to, color ^ COLOR_MASK, after) & after))
+            break;
+
+        // If this capture loses even when not recaptured, and not capturing
+        // loses too, the result is already decided.
+        const int next = SEE_VALUES[target & TYPE_MASK] - gain[depth];
+        if (std::max(-gain[depth], next) < 0)
+            break;
+        gain[++depth] = next;
+        occupied = after;
+        target = attacker;
+    }
+    // Work back, letting each player stop capturing if that's better.
+    for (; depth > 0; --depth)
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    return gain[0];
+}
+
+auto Board::see(u8 column, u8 row) const -> int {
+    const u8 piece = pieceAt(column, row);
+    if (!piece)
+        return 0;
+    const u8 to = Bitboard::square(column, row);
+    const u8 color = (piece & COLOR_MASK) ^ COLOR_MASK;
+    const u64 occupied = m_occupied[0] | m_occupied[1];
+    u8 attacker = EMPTY;
+    const u8 from = leastValuableAttacker(attackersOf(to, color, occupied),
+                                          color, attacker);
+    if (from == 64U)
+        return 0;
+    // A king can't capture a defended piece.
+    const u64 after = occupied ^ Bitboard::bit(from);
+    if ((attacker & TYPE_MASK) == KING &&
+        (attackersOf(to, piece & COLOR_MASK, after) & after))
+        return 0;
+
+    Move move{Bitboard::column(from), column, Bitboard::row(from), row};
+    if ((attacker & TYPE_MASK) == PAWN && (row == 0 || row == GRID_LENGTH - 1))
+        move.promotion = QUEEN | color;
+    return see(move);
+}
+
+auto Board::getCheckInfo() const -> CheckInfo {
+    const u8 mycolor = whiteMove() ? WHITE : BLACK;
+    const u8 enemy = whiteMove() ? BLACK : WHITE;
+    CheckInfo info;
+
+    const u64 king = m_bitboards[KING | mycolor];
+    if (!king)
+        return info;
+    info.king = Bitboard::first(king);
+
+    const u64 occupied = m_occupied[0] | m_occupied[1];
+    info.checkers = attackersOf(info.king, enemy, occupied);
+    if (info.checkers) {
+        // With one checker we can capture it, or block it if it is a
+        // slider. With two, only the king can move.
+        const u8 checker = Bitboard::first(info.checkers);
+        info.checkMask =
+            Bitboard::count(info.checkers) > 1
+                ? 0U
+                : info.checkers | Bitboard::BETWEEN[info.king][checker];
+    }
+
+    // Find opponent sliders that would attack the king if the board were
+    // empty. If exactly one piece stands in between and it's ours, it is
+    // pinned.
+    const u64 queens = m_bitboards[QUEEN | enemy];
+    u64 snipers = (Bitboard::rookAttacks(info.king, 0U) &
+                   (m_bitboards[ROOK | enemy] | m_bitboards[CASTLE | enemy] |
+                    queens)) |
+                  (Bitboard::bishopAttacks(info.king, 0U) &
+                   (m_bitboards[BISHOP | enemy] | queens));
+    while (snipers) {
+        const u8 sniper = Bitboard::popFirst(snipers);
+        const u64 between = Bitboard::BETWEEN[info.king][sniper] & occupied;
+        if (Bitboard::count(between) == 1 &&
+            (between & m_occupied[Bitboard::colorIndex(mycolor)]))
+            info.pinned |= between;
+    }
+    return info;
+}
+
+auto Board::getLegalTargets(u8 piece, u8 square, const CheckInfo &info) const
+    -> u64 {
+    u64 targets = getTargets(piece, square);
+
+    // No king, so nothing to worry about.
+    if (info.king == 64U)
+        return targets;
+
+    if ((piece & TYPE_MASK) == KING) {
+        // The king can't move onto an attacked tile. Take the king off the
+        // board first, so it doesn't hide tiles behind it from sliders.
+        const u8 enemy = (piece & COLOR_MASK) == WHITE ? BLACK : WHITE;
+        const u64 occupied =
+            (m_occupied[0] | m_occupied[1]) & ~Bitboard::bit(square);
+        u64 legal = 0U;
+        while (targets) {
+            const u8 to = Bitboard::popFirst(targets);
+            if (!attackersOf(to, enemy, occupied))
+                legal |= Bitboard::bit(to);
+        }
+        return legal;
+    }
+
+    targets &= info.checkMask;
+    if (info.pinned & Bitboard::bit(square))
+        targets &= Bitboard::LINE[info.king][square];
+    return targets;
+}
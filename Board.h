@@ -1,8 +1,12 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "Bitboard.h"
 #include "Move.h"
+#include "MoveList.h"
+#include "Random.h"
 #include "Types.h"
+#include "Zobrist.h"
 #include <array>
 #include <iostream>
 #include <math.h>
@@ -10,6 +14,24 @@
 #include <unordered_map>
 #include <vector>
 
+// Everything needed to take back a move with Board::unmakeMove().
+struct Undo {
+    Move move = {};
+    // Piece that moved, as it was before the move (e.g. a pawn that then
+    // promoted).
+    u8 piece = EMPTY;
+    // Piece that was captured, or EMPTY. For en passant, the captured pawn
+    // is on the source row rather than the target row.
+    u8 captured = EMPTY;
+    u8 capturedRow = 0U;
+    // Board state bits before the move (turn, en passant, stale).
+    u8 bits = 0U;
+    // Tiles of unmoved rooks (CASTLE) before the move, for castling rights.
+    u64 castles = 0U;
+    // Zobrist hash before the move.
+    u64 hash = 0U;
+};
+
 // Holds board state.
 // Board state is held in m_pieces.
 struct Board {
@@ -27,6 +49,20 @@ struct Board {
     // Returns the colour of the specified tile. (WHITE or BLACK)
     auto colorAt(u8 column, u8 row) const -> u8;
 
+    // Returns the tiles of all pieces of the specified colour. Iterating
+    // these with Bitboard::popFirst() visits only the pieces that exist.
+    auto pieces(u8 color) const -> u64;
+
+    // Returns the tiles holding the specified piece (e.g. KNIGHT | WHITE).
+    auto tiles(u8 piece) const -> u64;
+
+    // Returns how many of the specified piece are on the board.
+    auto count(u8 piece) const -> u8;
+
+    // Returns the tile index (see Bitboard::square()) of the specified
+    // player's king, or 64 if they have no king.
+    auto kingSquare(u8 color) const -> u8;
+
     // Sets the piece at the specified position to the specified piece.
     // piece must bitwise AND with exactly one type and one colour;
     // otherwise, the behaviour is undefined.
@@ -49,6 +85,27 @@ struct Board {
     // if none legal).
     auto getMoves(u8 count = 0) -> std::vector<Move>;
 
+    // Same as above, but fills the specified list instead of allocating a
+    // new one. The list is cleared first.
+    auto getMoves(MoveList &moves, u8 count = 0) -> void;
+
+    // Returns the number of legal moves for the player whose move it is,
+    // the same as getMoves().size(), but without building the moves.
+    auto countMoves() -> u32;
+
+    // Same as above, but for the specified player (WHITE or BLACK), as if
+    // it were their move, so that evaluations can count a fixed player's
+    // moves whoever is on move. En passant is never available to the
+    // player who isn't on move.
+    auto countMoves(u8 color) -> u32;
+
+    // Sets move to a random legal move for the player whose move it is,
+    // every move being equally likely, and returns true; or returns false if
+    // there are none. Quicker than picking from getMoves(), as only the move
+    // picked is checked for the hard cases (king moves, castling and en
+    // passant).
+    auto randomMove(Random &random, Move &move) -> bool;
+
     // Returns whether the specified player (WHITE or BLACK) has exactly
     // zero moves remaining. (For checkmate and stalemate situations)
     auto hasZeroMoves() -> bool;
@@ -70,12 +127,39 @@ struct Board {
     // square, would be attacked.
     auto isAttacked(u8 column, u8 row, u8 piece) const -> bool;
 
+    // Returns every tile the specified player (WHITE or BLACK) attacks,
+    // whether or not a piece is on it. Computed in one pass over their
+    // pieces, so it's cheaper than calling isAttacked() for many tiles.
+    auto attackMap(u8 color) const -> u64;
+
+    // Same as above, but also fills counts with how many of the player's
+    // pieces attack each tile, indexed by Bitboard::square().
+    auto attackMap(u8 color, std::array<u8, 64> &counts) const -> u64;
+
+    // Static exchange evaluation: the material (a pawn is 100) won by the
+    // move, or lost if negative, if both players then keep recapturing on
+    // the target tile with their least valuable piece for as long as it pays.
+    // Pins and checks are ignored.
+    auto see(const Move &move) const -> int;
+
+    // Same as above, for the opponent of the piece on the tile capturing it
+    // with their least valuable attacker. Returns 0 if the tile is empty or
+    // can't be captured.
+    auto see(u8 column, u8 row) const -> int;
+
     // Returns true if the move is an en passant capture.
     auto isEnPassant(const Move &move) const -> bool;
 
     // Returns the current board state, depending on whose turn it is.
     auto getBoardState(uint16_t staleHalfMoveClock) -> BoardState;
 
+    // Returns true if neither player has enough pieces left to checkmate.
+    auto hasInsufficientMaterial() const -> bool;
+
+    // Returns the value of the player's pieces other than the king, where a
+    // pawn is 100 (the same values as see()).
+    auto materialValue(u8 color) const -> int;
+
     // Returns true if the specified player has moved their king. (For
     // castling rules.)
     auto kingMoved(u8 player) const -> bool;
@@ -87,6 +171,13 @@ struct Board {
     // invalid.
     auto enPassantColumn() const -> u8;
 
+    // Sets whose move it is. (For setting up positions, e.g. from a FEN.)
+    auto setWhiteMove(bool white) -> void;
+
+    // Sets the column where an en passant is possible, i.e. the column of
+    // the last double pawn move. Set to 255 for none.
+    auto setEnPassantColumn(u8 column) -> void;
+
     // Returns castling possibility.
     auto canCastle(u8 color, bool queenSide) -> bool;
 
@@ -94,23 +185,33 @@ struct Board {
     // capture
     auto isStale() -> bool;
 
+    // Returns the Zobrist hash of the position. Boards with the same pieces
+    // on the same tiles, side to move, castling rights and en passant column
+    // have the same hash.
+    auto hash() const -> u64;
+
+    // Does a move without checking if it is legal, just does it. Returns
+    // what is needed to take the move back again with unmakeMove().
+    auto makeMove(const Move &move) -> Undo;
+
+    // Takes back a move done with makeMove(). Moves must be taken back in
+    // the reverse order they were made.
+    auto unmakeMove(const Undo &undo) -> void;
+
     // Try a move and then revert the board state.
     // The function f() is a user-specified function to check the board
     // state.
     template <class T>
     auto tryMove(const Move &move, const T &func) -> decltype(func()) {
-        const u32 src = m_pieces[move.fromRow];
-        const u32 dest = m_pieces[move.toRow];
-        const u8 bits = m_bits;
-        forceDoMove(move);
+        const Undo undo = makeMove(move);
         auto result = func();
-        m_pieces[move.fromRow] = src;
-        m_pieces[move.toRow] = dest;
-        m_bits = bits;
+        unmakeMove(undo);
         return result;
     }
 
   protected:
+    friend struct MoveGenerator;
+
     // Board pieces.
     // Each piece is stored in a u8, but actually only takes up 4 bits.
     // Since a chess grid is 8x8, this means we can encode each row as 4
@@ -126,8 +227,19 @@ struct Board {
     // the last move was "stale".
     u8 m_bits = 0U;
 
-    // Do a move without checking if it is legal, just do it.
-    auto forceDoMove(const Move &move) -> void;
+    // Bitboards, kept in sync with m_pieces by setPiece() and removePiece().
+    // m_bitboards is indexed by the 4-bit piece (e.g. ROOK | WHITE) and holds
+    // a bit for every tile that piece is on. m_occupied holds every tile
+    // occupied by each colour, indexed by Bitboard::colorIndex().
+    std::array<u64, 16> m_bitboards;
+    std::array<u64, 2> m_occupied;
+
+    // Zobrist hash, updated along with the pieces and m_bits.
+    u64 m_hash = 0U;
+
+    // Material signature; how many of each piece are on the board. 4 bits
+    // per piece, so piece p is counted in bits p * 4 to p * 4 + 3.
+    u64 m_material = 0U;
 
     // Checks whether the specified column and row is within the confines of
     // the board.
@@ -144,6 +256,56 @@ struct Board {
     // Returns whether the specified move would leave the player in check.
     // This is an illegal move.
     auto isMoveIntoCheck(const Move &move) -> bool;
+
+    // Checks and pins against the king of the side to move. Computed once
+    // per position so each move doesn't have to be tried to see whether it
+    // leaves the king in check.
+    struct CheckInfo {
+        // Tile of the king, or 64 if there is no king on the board.
+        u8 king = 64U;
+        // Opponent pieces giving check.
+        u64 checkers = 0U;
+        // Our pieces that can only move along the line to the king.
+        u64 pinned = 0U;
+        // Tiles a piece other than the king must move to, in order to
+        // capture or block a single checker.
+        u64 checkMask = ~u64{0};
+    };
+
+    // Returns the checks and pins for the side to move.
+    auto getCheckInfo() const -> CheckInfo;
+
+    // Returns the tiles of all pieces of the specified colour that attack
+    // the tile, given which tiles are occupied.
+    auto attackersOf(u8 square, u8 color, u64 occupied) const -> u64;
+
+    // Returns the tile of the least valuable of the specified attackers of
+    // the colour and sets piece to it, or returns 64 if there are none.
+    auto leastValuableAttacker(u64 attackers, u8 color, u8 &piece) const
+        -> u8;
+
+    // Returns the tiles the piece on the specified tile attacks, given which
+    // tiles are occupied.
+    auto attacksFrom(u8 piece, u8 square, u64 occupied) const -> u64;
+
+    // Returns the tiles the piece on the specified tile can legally move to,
+    // except for castling and en passant.
+    auto getLegalTargets(u8 piece, u8 square, const CheckInfo &info) const
+        -> u64;
+
+    // Adds the legal moves of the piece on the specified tile to the list,
+    // but only the kinds of move specified (see MoveKind).
+    auto addMoves(MoveList &moves, u8 square, const CheckInfo &info, u8 kinds)
+        -> void;
+
+    // Returns the tiles the piece on the specified tile can legally move to
+    // by castling or en passant.
+    auto getSpecialTargets(u8 piece, u8 square) -> u64;
+
+    // Returns the tiles the piece on the specified tile could move to,
+    // ignoring check, castling and en passant. Tiles holding our own pieces
+    // or the opponent's king are excluded.
+    auto getTargets(u8 piece, u8 square) const -> u64;
 };
 
 #endif
\ No newline at end of file
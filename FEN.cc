@@ -48,6 +48,26 @@ static auto toChar(u8 piece) -> char {
     }
 }
 
+static auto fromChar(char c) -> u8 {
+    const u8 color = (c >= 'a' && c <= 'z') ? BLACK : WHITE;
+    switch (c | 32) {
+    case 'p':
+        return PAWN | color;
+    case 'b':
+        return BISHOP | color;
+    case 'n':
+        return KNIGHT | color;
+    case 'q':
+        return QUEEN | color;
+    case 'k':
+        return KING | color;
+    case 'r':
+        return ROOK | color;
+    default:
+        return EMPTY;
+    }
+}
+
 auto toFEN(Board *board, u16 halfMoveStaleClock, u16 fullMoveclock)
     -> std::string {
     std::ostringstream oss;
@@ -77,4 +97,57 @@ auto toFEN(Board *board, u16 halfMoveStaleClock, u16 fullMoveclock)
         << halfMoveStaleClock << ' ' << fullMoveclock;
     return oss.str();
 }
+auto fromFEN(Board *board, const std::string &fen) -> bool {
+    std::istringstream iss(fen);
+    std::string pieces, side, castles, enPassant;
+    if (!(iss >> pieces >> side >> castles >> enPassant))
+        return false;
+
+    board->reset();
+    // Every rank must cover exactly GRID_LENGTH files, and there must be
+    // GRID_LENGTH ranks.
+    u8 row = GRID_LENGTH - 1, col = 0;
+    for (char c : pieces) {
+        if (c == '/') {
+            if (row-- == 0 || col != GRID_LENGTH)
+                return false;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            if (col + (c - '0') > GRID_LENGTH)
+                return false;
+            col += c - '0';
+        } else {
+            const u8 piece = fromChar(c);
+            if (piece == EMPTY || col >= GRID_LENGTH)
+                return false;
+            board->setPiece(piece, col++, row);
+        }
+    }
+    if (row != 0 || col != GRID_LENGTH)
+        return false;
+
+    if (side != "w" && side != "b")
+        return false;
+    board->setWhiteMove(side == "w");
+
+    // Rooks that can still castle are unmoved rooks (CASTLE)
+    for (char c : castles) {
+        const u8 color = c == 'K' || c == 'Q' ? WHITE : BLACK;
+        const u8 column = c == 'K' || c == 'k' ? 7 : 0;
+        const u8 row = color == WHITE ? 0 : GRID_LENGTH - 1;
+        if (c == '-')
+            continue;
+        else if ((c | 32) != 'k' && (c | 32) != 'q')
+            return false;
+        else if (board->pieceAt(column, row) == (ROOK | color))
+            board->setPiece(CASTLE | color, column, row);
+    }
+
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h')
+            return false;
+        board->setEnPassantColumn(enPassant[0] - 'a');
+    }
+    return true;
+}
 } // namespace FEN
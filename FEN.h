@@ -7,6 +7,15 @@
 namespace FEN {
 auto toFEN(Board *board, u16 halfMoveStaleClock, u16 fullMoveclock)
     -> std::string;
+
+// Standard starting position.
+const char *const START =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Sets up the board from a FEN string. Returns false if the string could not
+// be parsed, in which case the board is left in an unspecified state. The
+// move clocks are optional and ignored.
+auto fromFEN(Board *board, const std::string &fen) -> bool;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "GameResult.h"
+#include "FEN.h"
+
+auto GameResult::isDecisive() const -> bool {
+    return state == STATE_CHECKMATE ||
+           state == STATE_ADJUDICATED_RESIGNATION ||
+           state == STATE_FORFEIT_ILLEGAL_MOVE;
+}
+
+auto GameResult::isAdjudicated() const -> bool {
+    return state == STATE_ADJUDICATED_DRAW_NO_CAPTURES ||
+           state == STATE_ADJUDICATED_DRAW_MAX_LENGTH ||
+           state == STATE_ADJUDICATED_RESIGNATION;
+}
+
+auto GameResult::whitePoints() const -> int {
+    if (!isDecisive())
+        return 1;
+    return winner == WHITE ? 2 : 0;
+}
+
+auto GameResult::score() const -> const char * {
+    switch (whitePoints()) {
+    case 2:
+        return "1-0";
+    case 0:
+        return "0-1";
+    default:
+        return "1/2-1/2";
+    }
+}
+
+auto GameResult::description() const -> std::string {
+    const std::string winnerName = winner == WHITE ? "White" : "Black";
+    const std::string loserName = winner == WHITE ? "Black" : "White";
+    switch (state) {
+    case STATE_CHECKMATE:
+        return "Checkmate (" + winnerName + " wins)";
+    case STATE_STALEMATE:
+        return "Stalemate";
+    case STATE_FORCED_DRAW_FIFTY_MOVES:
+        return "Draw by 50 move rule";
+    case STATE_FORCED_DRAW_INSUFFICIENT_MATERIAL:
+        return "Draw by insufficient material";
+    case STATE_FORCED_DRAW_REPETITION:
+        return "Draw by threefold repetition";
+    case STATE_ADJUDICATED_DRAW_NO_CAPTURES:
+        return "Draw by adjudication (no captures)";
+    case STATE_ADJUDICATED_DRAW_MAX_LENGTH:
+        return "Draw by adjudication (game too long)";
+    case STATE_ADJUDICATED_RESIGNATION:
+        return loserName + " resigns (" + winnerName +
+               " wins by adjudication)";
+    case STATE_FORFEIT_ILLEGAL_MOVE:
+        return loserName + " forfeits by an illegal move (" + winnerName +
+               " wins)";
+    case STATE_NORMAL:
+    default:
+        return "Game terminated abruptly";
+    }
+}
+
+auto GameResult::fen() const -> std::string {
+    // Games start from the standard position, so it's white's move at the
+    // start of every full move.
+    Board copy{board};
+    return FEN::toFEN(&copy, staleHalfMoveClock, plies / 2 + 1);
+}
+
+auto operator<<(std::ostream &out, const GameResult &result)
+    -> std::ostream & {
+    return out << result.description() << "\n"
+               << result.fen() << "\nSeed: " << result.seed;
+}
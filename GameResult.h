@@ -0,0 +1,48 @@
+#ifndef GAMERESULT_H
+#define GAMERESULT_H
+
+#include "Board.h"
+#include "Move.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// How a game played by a Runner went. Nothing is formatted until it is
+// asked for, so results can be counted up or streamed without building
+// strings.
+struct GameResult {
+    // How the game ended, or STATE_NORMAL if it was cut short.
+    BoardState state = STATE_NORMAL;
+    // The winner (WHITE or BLACK), if isDecisive().
+    u8 winner = 0U;
+    // Half moves played, and half moves since the last capture or pawn move.
+    u16 plies = 0U;
+    u16 staleHalfMoveClock = 0U;
+    // Seed the players were seeded from.
+    u64 seed = 0U;
+    // Position at the end, and the moves played from the starting position
+    // to get there.
+    Board board = {};
+    std::vector<Move> moves = {};
+
+    // Returns whether one player won (by checkmate, resignation or the other
+    // playing an illegal move).
+    auto isDecisive() const -> bool;
+    // Returns whether the game was ended by the Runner's adjudication rules.
+    auto isAdjudicated() const -> bool;
+    // Returns white's points, in half points: 2 for a win, 1 for a draw and
+    // 0 for a loss.
+    auto whitePoints() const -> int;
+
+    // Returns the score as written in PGN: "1-0", "0-1" or "1/2-1/2".
+    auto score() const -> const char *;
+    // Returns how the game ended, e.g. "Checkmate (White wins)".
+    auto description() const -> std::string;
+    // Returns the final position as a FEN.
+    auto fen() const -> std::string;
+};
+
+// Prints the description, the final FEN and the seed, one per line.
+auto operator<<(std::ostream &out, const GameResult &result) -> std::ostream &;
+
+#endif
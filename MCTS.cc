@@ -0,0 +1,247 @@
+#include "MCTS.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// Exploration constant for UCT. Higher tries more moves, lower looks deeper
+// at the moves that have won so far.
+constexpr double EXPLORATION = 1.41;
+// Deepest the tree is followed; below this, games are just played out.
+constexpr int MAX_TREE_DEPTH = 128;
+
+using Clock = std::chrono::steady_clock;
+
+// A position in the tree, reached by playing move.
+struct Node {
+    Move move = {};
+    // Player who played move; wins are counted for them.
+    u8 color = 0U;
+    // Whether children has been filled in. Nodes at the end of a game have
+    // no children.
+    bool expanded = false;
+    u16 childCount = 0U;
+    Node *children = nullptr;
+    u32 visits = 0U;
+    // 1 for every playout won by color, 0.5 for every draw.
+    float wins = 0.0F;
+};
+
+// One thread's tree, and what it needs to grow it.
+struct Tree {
+    Board &board;
+    Arena &arena;
+    Random &random;
+    Node *root;
+    u64 playouts;
+
+    // Follows the tree down to a new position, plays a random game from it
+    // and counts the result in every node on the way.
+    auto playout() -> void;
+
+    // Adds a child for every move (in random order, so that the first
+    // unvisited child is a random one) unless the game is over.
+    auto expand(Node &node, u16 staleClock) -> void;
+
+    // Returns the child with the best UCT score, or the first one not yet
+    // visited.
+    auto select(const Node &node) const -> Node &;
+
+    // Plays random moves until the game is over, and returns the result
+    // for white: 1 for a win, 0.5 for a draw and 0 for a loss.
+    auto simulate(u16 staleClock) -> float;
+};
+
+auto Tree::playout() -> void {
+    std::array<Node *, MAX_TREE_DEPTH + 1> path;
+    std::array<Undo, MAX_TREE_DEPTH> undos;
+    int depth = 0;
+    u16 staleClock = 0;
+    path[0] = root;
+    for (Node *node = root; depth < MAX_TREE_DEPTH;) {
+        if (!node->expanded)
+            expand(*node, staleClock);
+        if (!node->childCount)
+            break;
+        node = &select(*node);
+        undos[depth] = board.makeMove(node->move);
+        path[++depth] = node;
+        staleClock = board.isStale() ? staleClock + 1 : 0;
+        if (!node->visits)
+            break;
+    }
+
+    const float white = simulate(staleClock);
+    for (int i = 0; i <= depth; ++i) {
+        ++path[i]->visits;
+        path[i]->wins += path[i]->color == WHITE ? white : 1.0F - white;
+    }
+    while (depth > 0)
+        board.unmakeMove(undos[--depth]);
+    ++playouts;
+}
+
+auto Tree::expand(Node &node, u16 staleClock) -> void {
+    node.expanded = true;
+    if (staleClock >= 100U || board.hasInsufficientMaterial())
+        return;
+    MoveList moves;
+    board.getMoves(moves);
+    std::shuffle(moves.begin(), moves.end(), random);
+    const u8 mycolor = board.whiteMove() ? WHITE : BLACK;
+    node.children = arena.make<Node>(moves.size());
+    node.childCount = moves.size();
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        node.children[i].move = moves[i];
+        node.children[i].color = mycolor;
+    }
+}
+
+auto Tree::select(const Node &node) const -> Node & {
+    const double logVisits = std::log(node.visits);
+    Node *best = node.children;
+    double bestScore = -1.0;
+    for (Node *child = node.children; child != node.children + node.childCount;
+         ++child) {
+        if (!child->visits)
+            return *child;
+        const double score =
+            child->wins / child->visits +
+            EXPLORATION * std::sqrt(logVisits / child->visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = child;
+        }
+    }
+    return *best;
+}
+
+auto Tree::simulate(u16 staleClock) -> float {
+    Board game{board};
+    Move move;
+    for (;;) {
+        if (staleClock >= 100U || game.hasInsufficientMaterial())
+            return 0.5F;
+        if (!game.randomMove(random, move)) {
+            const u8 mycolor = game.whiteMove() ? WHITE : BLACK;
+            if (!game.isCheck(mycolor))
+                return 0.5F;
+            return mycolor == WHITE ? 0.0F : 1.0F;
+        }
+        game.makeMove(move);
+        staleClock = game.isStale() ? staleClock + 1 : 0;
+    }
+}
+} // namespace
+
+auto MCTSOptions::set(const std::string &option) -> bool {
+    const auto equals = option.find('=');
+    const auto name = option.substr(0, equals);
+    const auto value =
+        equals == std::string::npos ? std::string{} : option.substr(equals + 1);
+    u64 number = 0U;
+    if (name == "playouts") {
+        if (!parseNumber(value, UINT64_MAX, number))
+            return false;
+        playouts = number;
+    } else if (name == "time") {
+        if (!parseNumber(value, UINT64_MAX, number))
+            return false;
+        time = number;
+    } else if (name == "threads") {
+        if (!parseNumber(value, MAX_THREADS, number))
+            return false;
+        threads = number;
+    } else if (option == "stats")
+        stats = true;
+    else
+        return false;
+    return true;
+}
+
+MCTSPlayer::MCTSPlayer(const MCTSOptions &options)
+    : m_options{options},
+      m_pool{options.threads > 1 ? std::make_unique<ThreadPool>(options.threads)
+                                 : nullptr} {
+    m_arenas.resize(options.threads);
+}
+
+auto MCTSPlayer::getMove(Board &board) const -> Move {
+    const auto start = Clock::now();
+    MoveList moves;
+    board.getMoves(moves);
+    if (moves.size() <= 1)
+        return moves[0];
+
+    // Root parallelism: every thread grows its own tree from its own copy of
+    // the board, so they share nothing until the end.
+    const int threads = m_options.threads;
+    std::vector<Board> boards(threads, board);
+    std::vector<Random> randoms;
+    std::vector<Tree> trees;
+    for (int i = 0; i < threads; ++i) {
+        m_arenas[i].reset();
+        randoms.emplace_back(m_random());
+    }
+    for (int i = 0; i < threads; ++i)
+        trees.push_back({boards[i], m_arenas[i], randoms[i],
+                         m_arenas[i].make<Node>(), 0U});
+
+    const auto deadline = start + std::chrono::milliseconds{m_options.time};
+    const auto grow = [&](std::size_t i, int) {
+        Tree &tree = trees[i];
+        // Split the playouts evenly, giving the remainder to the first trees.
+        const u64 playouts = m_options.playouts / threads +
+                             (i < m_options.playouts % threads ? 1U : 0U);
+        while ((!m_options.playouts || tree.playouts < playouts) &&
+               (!m_options.time || Clock::now() < deadline))
+            tree.playout();
+    };
+    if (m_pool)
+        m_pool->parallelFor(threads, grow);
+    else
+        grow(0, 0);
+
+    // Add up the visits to each move over all the trees.
+    std::array<u64, MoveList::CAPACITY> visits = {};
+    u64 playouts = 0;
+    for (const Tree &tree : trees) {
+        playouts += tree.playouts;
+        const Node *children = tree.root->children;
+        for (std::size_t i = 0; i < tree.root->childCount; ++i) {
+            const auto move =
+                std::find(moves.begin(), moves.end(), children[i].move);
+            visits[move - moves.begin()] += children[i].visits;
+        }
+    }
+    const std::size_t best =
+        std::max_element(visits.begin(), visits.begin() + moves.size()) -
+        visits.begin();
+
+    if (m_options.stats) {
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::size_t used = 0;
+        for (const Arena &arena : m_arenas)
+            used += arena.used();
+        std::cerr << "mcts: " << playouts << " playouts, " << threads
+                  << " threads, "
+                  << static_cast<u64>(playouts / elapsed.count())
+                  << " playouts/second, best move visited "
+                  << (playouts ? 100.0 * visits[best] / playouts : 0.0)
+                  << "%, tree " << used / sizeof(Node) << " nodes ("
+                  << used / 1024 << "KB)" << std::endl;
+    }
+    return moves[best];
+}
+
+std::unique_ptr<Player> makeMCTS() {
+    return makeMCTSPlayer(MCTSOptions{});
+}
+
+std::unique_ptr<Player> makeMCTSPlayer(const MCTSOptions &options) {
+    if ((!options.playouts && !options.time) || options.threads < 1)
+        return nullptr;
+    return std::make_unique<MCTSPlayer>(options);
+}
@@ -0,0 +1,60 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include "Arena.h"
+#include "Board.h"
+#include "Player.h"
+#include "ThreadPool.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Settings for an MCTSPlayer.
+struct MCTSOptions {
+    // Random games to play per move, shared between the threads. (0 for no
+    // limit, if there is a time limit.)
+    u64 playouts = 2000U;
+    // Stop after this many milliseconds per move. (0 for no limit.)
+    u64 time = 0U;
+    // Threads to play with. Each grows its own tree, and their visits are
+    // added up at the end (root parallelism).
+    int threads = 1;
+    // Print statistics to std::cerr after each move.
+    bool stats = false;
+
+    // Sets an option from the command line: playouts=<n>, time=<ms>,
+    // threads=<n> or stats. Returns false if the option isn't recognized,
+    // or its value isn't a number.
+    auto set(const std::string &option) -> bool;
+};
+
+// A player that plays lots of random games (playouts), as RandomPlayer would,
+// and picks the move that they show to be best.
+//
+// Uses Monte Carlo tree search with UCT: the games played so far are kept in
+// a tree, and each new game follows the tree down, trading off moves that
+// have won often against moves that have been tried little, until it reaches
+// a position not yet in the tree. That position is added, and from there the
+// game is played out at random. The move played is the one visited most.
+//
+// Tree nodes come from an Arena that is reset every move, so growing the
+// tree never calls new, and throwing it away is free.
+struct MCTSPlayer : Player {
+    explicit MCTSPlayer(const MCTSOptions &options);
+    auto getMove(Board &board) const -> Move override;
+
+  protected:
+    MCTSOptions m_options;
+    std::unique_ptr<ThreadPool> m_pool = nullptr;
+    // Memory for each thread's tree.
+    mutable std::vector<Arena> m_arenas = {};
+};
+
+// Default MCTS player (2000 playouts per move).
+std::unique_ptr<Player> makeMCTS();
+
+// MCTS player with the specified options. Returns nullptr if there's neither
+// a playout nor a time limit, or threads is less than 1.
+std::unique_ptr<Player> makeMCTSPlayer(const MCTSOptions &options);
+
+#endif
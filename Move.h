@@ -9,6 +9,8 @@ struct Move {
     u8 fromCol = 0U, toCol = 0U;
     u8 fromRow = 0U, toRow = 0U;
     u8 promotion = 0U;
+
+    auto operator==(const Move &other) const -> bool = default;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "MoveGenerator.h"
+
+MoveGenerator::MoveGenerator(Board &board, u8 kinds)
+    : m_board(board), m_info(board.getCheckInfo()), m_kinds(kinds) {}
+
+auto MoveGenerator::next(Move &move) -> bool {
+    while (m_index == m_moves.size()) {
+        // Out of pieces, so move on to the next stage we want
+        while (!m_pieces) {
+            if (m_stage > QUIET_MOVES)
+                return false;
+            do
+                m_stage = m_stage ? m_stage << 1 : CAPTURE_MOVES;
+            while (m_stage <= QUIET_MOVES && !(m_stage & m_kinds));
+
+            if (m_stage > QUIET_MOVES)
+                return false;
+
+            const u8 mycolor = m_board.whiteMove() ? WHITE : BLACK;
+            m_pieces = m_board.m_occupied[Bitboard::colorIndex(mycolor)];
+        }
+
+        m_moves.clear();
+        m_index = 0U;
+        m_board.addMoves(m_moves, Bitboard::popFirst(m_pieces), m_info,
+                         m_stage);
+    }
+    move = m_moves[m_index++];
+    return true;
+}
+
+auto MoveGenerator::stage() const -> u8 { return m_stage; }
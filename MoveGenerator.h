@@ -0,0 +1,35 @@
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include "Board.h"
+
+// Generates legal moves one at a time, in stages: captures first, then
+// promotions, then quiet moves. Each stage works through our pieces one at a
+// time, so a caller that stops early (e.g. only wants to know if there is
+// any move, or only wants captures) doesn't pay for moves it never sees.
+// The board must not change while generating, apart from trying a move and
+// taking it back.
+struct MoveGenerator {
+    // kinds restricts which stages are generated; see MoveKind.
+    explicit MoveGenerator(Board &board, u8 kinds = ALL_MOVES);
+
+    // Sets move to the next legal move and returns true, or returns false if
+    // there are no more moves.
+    auto next(Move &move) -> bool;
+
+    // Returns the stage (a MoveKind) of the last move returned by next().
+    auto stage() const -> u8;
+
+  private:
+    Board &m_board;
+    Board::CheckInfo m_info;
+    u8 m_kinds;
+    u8 m_stage = 0U;
+    // Pieces left to generate moves for in this stage.
+    u64 m_pieces = 0U;
+    // Moves for the current piece, and how many of them we've returned.
+    MoveList m_moves = {};
+    std::size_t m_index = 0U;
+};
+
+#endif
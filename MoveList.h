@@ -0,0 +1,39 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "Move.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+// Fixed capacity list of moves, to be kept on the stack.
+// No legal position has more than 218 moves, so a full list of moves for a
+// position always fits, and filling one never allocates.
+struct MoveList {
+    using value_type = Move;
+
+    static constexpr std::size_t CAPACITY = 256U;
+
+    auto push_back(const Move &move) -> void {
+        assert(m_size < CAPACITY);
+        m_moves[m_size++] = move;
+    }
+
+    auto clear() -> void { m_size = 0U; }
+    auto size() const -> std::size_t { return m_size; }
+    auto empty() const -> bool { return m_size == 0U; }
+
+    auto operator[](std::size_t i) -> Move & { return m_moves[i]; }
+    auto operator[](std::size_t i) const -> const Move & { return m_moves[i]; }
+
+    auto begin() -> Move * { return m_moves.data(); }
+    auto end() -> Move * { return m_moves.data() + m_size; }
+    auto begin() const -> const Move * { return m_moves.data(); }
+    auto end() const -> const Move * { return m_moves.data() + m_size; }
+
+  private:
+    std::array<Move, CAPACITY> m_moves = {};
+    std::size_t m_size = 0U;
+};
+
+#endif
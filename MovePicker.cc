@@ -0,0 +1,91 @@
+#include "MovePicker.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+// Move scores; each kind of move is ordered above the next.
+constexpr int PRIORITY_SCORE = 1 << 30;
+constexpr int TACTICAL_SCORE = 1 << 24;
+constexpr int KILLER_SCORE = 1 << 23;
+// History counts are halved when one reaches this, so they stay below the
+// killers and favour recent cutoffs.
+constexpr u32 HISTORY_LIMIT = 1 << 22;
+
+// Piece values for MVV-LVA, indexed by type. (ROOK and CASTLE are both
+// rooks.) The king is only ever an attacker, and is the least welcome one.
+constexpr std::array<int, 8> VALUES = {0, 1, 3, 3, 9, 20, 5, 5};
+
+auto from(const Move &move) -> u8 {
+    return Bitboard::square(move.fromCol, move.fromRow);
+}
+
+auto to(const Move &move) -> u8 {
+    return Bitboard::square(move.toCol, move.toRow);
+}
+} // namespace
+
+auto MoveHistory::addCutoff(const Move &move, u8 ply, u8 depth) -> void {
+    if (ply < MAX_PLY && !(killers[ply][0] == move)) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+    u32 &count = history[from(move)][to(move)];
+    count += depth * depth;
+    if (count >= HISTORY_LIMIT)
+        for (auto &row : history)
+            for (auto &entry : row)
+                entry /= 2;
+}
+
+auto MoveHistory::clear() -> void {
+    killers = {};
+    history = {};
+}
+
+MovePicker::MovePicker(const Board &board, MoveList &moves,
+                       const Move &priority, const MoveHistory &history,
+                       u8 ply)
+    : m_moves{moves} {
+    const auto &killers =
+        history.killers[std::min<u8>(ply, MoveHistory::MAX_PLY - 1)];
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const Move &move = moves[i];
+        int score;
+        if (move == priority)
+            score = PRIORITY_SCORE;
+        else if (isTactical(board, move)) {
+            const u8 attacker = board.pieceAt(move.fromCol, move.fromRow);
+            const u8 victim = board.isEnPassant(move)
+                                  ? u8{PAWN}
+                                  : board.pieceAt(move.toCol, move.toRow);
+            score = TACTICAL_SCORE + VALUES[victim & TYPE_MASK] * 64 +
+                    VALUES[move.promotion & TYPE_MASK] * 64 -
+                    VALUES[attacker & TYPE_MASK];
+        } else if (move == killers[0])
+            score = KILLER_SCORE;
+        else if (move == killers[1])
+            score = KILLER_SCORE - 1;
+        else
+            score = history.history[from(move)][to(move)];
+        m_scores[i] = score;
+    }
+}
+
+auto MovePicker::next(Move &move) -> bool {
+    if (m_index >= m_moves.size())
+        return false;
+    // Selection sort, one step at a time.
+    std::size_t best = m_index;
+    for (std::size_t i = m_index + 1; i < m_moves.size(); ++i)
+        if (m_scores[i] > m_scores[best])
+            best = i;
+    std::swap(m_moves[m_index], m_moves[best]);
+    std::swap(m_scores[m_index], m_scores[best]);
+    move = m_moves[m_index++];
+    return true;
+}
+
+auto MovePicker::isTactical(const Board &board, const Move &move) -> bool {
+    return move.promotion || board.pieceAt(move.toCol, move.toRow) ||
+           board.isEnPassant(move);
+}
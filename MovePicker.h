@@ -0,0 +1,56 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "Board.h"
+#include "MoveList.h"
+#include <array>
+
+// What a search has learned about which quiet moves tend to be good, for
+// ordering moves. Each search thread keeps its own.
+struct MoveHistory {
+    // Plies we keep killer moves for.
+    static constexpr u8 MAX_PLY = 64;
+
+    // Killer moves: the last two quiet moves that caused a beta cutoff at
+    // each ply. The same move often refutes the sibling positions too.
+    std::array<std::array<Move, 2>, MAX_PLY> killers = {};
+
+    // Butterfly history: how often each quiet move, indexed by from tile
+    // then to tile, has caused a cutoff, weighted by depth.
+    std::array<std::array<u32, 64>, 64> history = {};
+
+    // Records a quiet move that caused a beta cutoff at the ply, searched
+    // to the specified depth.
+    auto addCutoff(const Move &move, u8 ply, u8 depth) -> void;
+
+    // Forgets everything.
+    auto clear() -> void;
+};
+
+// Hands out the moves of a MoveList best first. The moves are all scored
+// once up front, but only sorted as far as they're picked, since after a
+// cutoff the rest of the moves are never needed.
+//
+// Order: the priority move (e.g. from the transposition table), then
+// captures and promotions by MVV-LVA (most valuable victim, then least
+// valuable attacker), then the killer moves, then the other quiet moves by
+// history.
+struct MovePicker {
+    MovePicker(const Board &board, MoveList &moves, const Move &priority,
+               const MoveHistory &history, u8 ply);
+
+    // Sets move to the next best move, or returns false once all have been
+    // picked.
+    auto next(Move &move) -> bool;
+
+    // Returns whether the move is a capture or promotion, which are ordered
+    // by MVV-LVA rather than history.
+    static auto isTactical(const Board &board, const Move &move) -> bool;
+
+  private:
+    MoveList &m_moves;
+    std::array<int, MoveList::CAPACITY> m_scores = {};
+    std::size_t m_index = 0U;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "PGN.h"
+#include "FEN.h"
+#include <ctime>
+
+namespace PGN {
+// Returns the letter for the piece in SAN, e.g. 'N' for a knight.
+static auto toLetter(u8 piece) -> char {
+    switch (piece & TYPE_MASK) {
+    case BISHOP:
+        return 'B';
+    case KNIGHT:
+        return 'N';
+    case QUEEN:
+        return 'Q';
+    case KING:
+        return 'K';
+    case CASTLE:
+    case ROOK:
+        return 'R';
+    default:
+        return '?';
+    }
+}
+
+// Returns the type of the piece, counting unmoved rooks (CASTLE) as rooks.
+static auto typeOf(u8 piece) -> u8 {
+    const u8 type = piece & TYPE_MASK;
+    return type == CASTLE ? static_cast<u8>(ROOK) : type;
+}
+
+// Appends the tag pair, e.g. [White "min"].
+static auto appendTag(std::string &out, const char *name,
+                      const std::string &value) -> void {
+    out += '[';
+    out += name;
+    out += " \"";
+    for (const char c : value) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    out += "\"]\n";
+}
+
+auto toSAN(Board *board, const Move &move) -> std::string {
+    std::string san;
+    const u8 piece = board->pieceAt(move.fromCol, move.fromRow);
+    const u8 type = typeOf(piece);
+    const int distance = move.toCol - move.fromCol;
+    if (type == KING && (distance == 2 || distance == -2)) {
+        san = distance > 0 ? "O-O" : "O-O-O";
+    } else {
+        const bool capture =
+            board->pieceAt(move.toCol, move.toRow) != EMPTY ||
+            (type == PAWN && board->isEnPassant(move));
+        if (type == PAWN) {
+            // The file a pawn captures from is enough to tell it apart.
+            if (capture)
+                san += static_cast<char>('a' + move.fromCol);
+        } else {
+            san += toLetter(piece);
+            // Only needed when another piece of the same type can move to
+            // the same tile: the file if that tells them apart, otherwise
+            // the rank if that does, otherwise both.
+            if (type != KING) {
+                bool ambiguous = false, sameCol = false, sameRow = false;
+                MoveList moves;
+                board->getMoves(moves);
+                for (const Move &other : moves) {
+                    if (other.toCol != move.toCol ||
+                        other.toRow != move.toRow ||
+                        (other.fromCol == move.fromCol &&
+                         other.fromRow == move.fromRow) ||
+                        typeOf(board->pieceAt(other.fromCol,
+                                              other.fromRow)) != type)
+                        continue;
+                    ambiguous = true;
+                    sameCol |= other.fromCol == move.fromCol;
+                    sameRow |= other.fromRow == move.fromRow;
+                }
+                if (ambiguous && (!sameCol || sameRow))
+                    san += static_cast<char>('a' + move.fromCol);
+                if (ambiguous && sameCol)
+                    san += static_cast<char>('1' + move.fromRow);
+            }
+        }
+        if (capture)
+            san += 'x';
+        san += static_cast<char>('a' + move.toCol);
+        san += static_cast<char>('1' + move.toRow);
+        if (move.promotion) {
+            san += '=';
+            san += toLetter(move.promotion);
+        }
+    }
+
+    const char suffix = board->tryMove(move, [board]() -> char {
+        if (!board->isCheck(board->whiteMove() ? WHITE : BLACK))
+            return 0;
+        return board->hasZeroMoves() ? '#' : '+';
+    });
+    if (suffix)
+        san += suffix;
+    return san;
+}
+
+auto toResult(const GameResult &result) -> const char * {
+    return result.state == STATE_NORMAL ? "*" : result.score();
+}
+
+auto appendGame(std::string &out, const std::string &date, std::size_t round,
+                const std::string &white, const std::string &black,
+                const GameResult &result) -> void {
+    const std::string score = toResult(result);
+    appendTag(out, "Event", "?");
+    appendTag(out, "Site", "?");
+    appendTag(out, "Date", date);
+    appendTag(out, "Round", std::to_string(round));
+    appendTag(out, "White", white);
+    appendTag(out, "Black", black);
+    appendTag(out, "Result", score);
+    appendTag(out, "Termination",
+              result.state == STATE_NORMAL                 ? "unterminated"
+              : result.state == STATE_FORFEIT_ILLEGAL_MOVE ? "rules infraction"
+              : result.isAdjudicated()                     ? "adjudication"
+                                                           : "normal");
+    appendTag(out, "PlyCount", std::to_string(result.moves.size()));
+    appendTag(out, "Seed", std::to_string(result.seed));
+    out += '\n';
+
+    // Moves, then how the game ended as a comment, then the result; each
+    // token goes on the next line if it would take this one past 80
+    // characters.
+    std::size_t length = 0U;
+    const auto append = [&out, &length](const std::string &token) {
+        if (length && length + 1 + token.size() > 80) {
+            out += '\n';
+            length = 0U;
+        } else if (length) {
+            out += ' ';
+            ++length;
+        }
+        out += token;
+        length += token.size();
+    };
+    Board board;
+    FEN::fromFEN(&board, FEN::START);
+    for (std::size_t ply = 0; ply < result.moves.size(); ++ply) {
+        if (ply % 2 == 0)
+            append(std::to_string(ply / 2 + 1) + ".");
+        append(toSAN(&board, result.moves[ply]));
+        board.makeMove(result.moves[ply]);
+    }
+    std::string comment = "{";
+    comment += result.description();
+    comment += '}';
+    append(comment);
+    append(score);
+    out += "\n\n";
+}
+} // namespace PGN
+
+PGNWriter::PGNWriter(std::ostream &out, std::size_t bufferSize)
+    : m_out{out}, m_bufferSize{bufferSize} {
+    const std::time_t now = std::time(nullptr);
+    char date[16];
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+    m_date = date;
+    m_buffer.reserve(m_bufferSize);
+}
+
+PGNWriter::~PGNWriter() { flush(); }
+
+auto PGNWriter::write(std::size_t round, const std::string &white,
+                      const std::string &black, const GameResult &result)
+    -> void {
+    // Each thread reuses its own string, so formatting a game doesn't
+    // allocate once it has grown to fit.
+    thread_local std::string game;
+    game.clear();
+    PGN::appendGame(game, m_date, round, white, black, result);
+
+    std::lock_guard lock{m_mutex};
+    m_buffer += game;
+    if (m_buffer.size() >= m_bufferSize) {
+        m_out.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+}
+
+auto PGNWriter::flush() -> void {
+    std::lock_guard lock{m_mutex};
+    m_out.write(m_buffer.data(), m_buffer.size());
+    m_out.flush();
+    m_buffer.clear();
+}
@@ -0,0 +1,55 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include "Board.h"
+#include "GameResult.h"
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace PGN {
+// Returns the move in standard algebraic notation (e.g. Nbd7, exd6, e8=Q+
+// or O-O#), for the position on the board. The move must be legal. The
+// board is left as it was.
+auto toSAN(Board *board, const Move &move) -> std::string;
+
+// Returns the result as written at the end of a PGN game: "1-0", "0-1",
+// "1/2-1/2", or "*" if the game was cut short.
+auto toResult(const GameResult &result) -> const char *;
+
+// Appends the game, from the standard starting position, to out in PGN:
+// the tags (round, players, result and so on) and then the moves, wrapped
+// at 80 characters, followed by a blank line.
+auto appendGame(std::string &out, const std::string &date, std::size_t round,
+                const std::string &white, const std::string &black,
+                const GameResult &result) -> void;
+}
+
+// Appends games in PGN to a stream, from any number of threads at once.
+// Each game is written out by the thread calling write() and then added to
+// a buffer in one piece, so games are never mixed up with each other and
+// the slow part (working out the SAN of every move) is done in parallel.
+// The buffer goes to the stream whenever it fills up, and on flush().
+struct PGNWriter {
+    explicit PGNWriter(std::ostream &out, std::size_t bufferSize = 1U << 16);
+    ~PGNWriter();
+    PGNWriter(const PGNWriter &) = delete;
+    auto operator=(const PGNWriter &) = delete;
+
+    // Appends the numbered game (its round) between the named players.
+    auto write(std::size_t round, const std::string &white,
+               const std::string &black, const GameResult &result) -> void;
+
+    // Writes out everything in the buffer.
+    auto flush() -> void;
+
+  private:
+    std::ostream &m_out;
+    std::size_t m_bufferSize;
+    // Today's date, for every game's Date tag.
+    std::string m_date = {};
+    std::mutex m_mutex = {};
+    std::string m_buffer = {};
+};
+
+#endif
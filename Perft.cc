@@ -0,0 +1,234 @@
+#include "Perft.h"
+#include "FEN.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace Perft {
+namespace {
+struct Position {
+    const char *name;
+    const char *fen;
+    // Known leaf counts, starting at depth 1.
+    std::vector<u64> counts;
+};
+
+// Positions and counts from https://www.chessprogramming.org/Perft_Results
+const std::vector<Position> SUITE = {
+    {"start", FEN::START, {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"kiwipete",
+     "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     {48, 2039, 97862, 4085603, 193690690}},
+    {"position 3",
+     "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     {14, 191, 2812, 43238, 674624, 11030083}},
+    {"position 4",
+     "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     {6, 264, 9467, 422333, 15833292}},
+    {"position 4 (mirrored)",
+     "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+     {6, 264, 9467, 422333, 15833292}},
+    {"position 5",
+     "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     {44, 1486, 62379, 2103487, 89941194}},
+    {"position 6",
+     "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 "
+     "10",
+     {46, 2079, 89890, 3894594, 164075551}},
+};
+
+// Returns the move in long algebraic notation, e.g. e2e4 or e7e8q.
+auto toString(const Move &move) -> std::string {
+    std::string s = {(char)('a' + move.fromCol), (char)('1' + move.fromRow),
+                     (char)('a' + move.toCol), (char)('1' + move.toRow)};
+    switch (move.promotion & TYPE_MASK) {
+    case QUEEN:
+        s.push_back('q');
+        break;
+    case KNIGHT:
+        s.push_back('n');
+        break;
+    case ROOK:
+        s.push_back('r');
+        break;
+    case BISHOP:
+        s.push_back('b');
+        break;
+    }
+    return s;
+}
+
+auto secondsSince(std::chrono::steady_clock::time_point start) -> double {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+} // namespace
+
+auto perft(Board &board, u8 depth) -> u64 {
+    if (depth == 0)
+        return 1U;
+
+    MoveList moves;
+    board.getMoves(moves);
+    // Leaf nodes are just counted, not played
+    if (depth == 1)
+        return moves.size();
+
+    u64 nodes = 0U;
+    for (const Move &move : moves) {
+        const Undo undo = board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(undo);
+    }
+    return nodes;
+}
+
+auto divide(Board &board, u8 depth, std::ostream &out) -> u64 {
+    const auto start = std::chrono::steady_clock::now();
+    MoveList moves;
+    board.getMoves(moves);
+
+    u64 nodes = 0U;
+    for (const Move &move : moves) {
+        const Undo undo = board.makeMove(move);
+        const u64 count = depth ? perft(board, depth - 1) : 0U;
+        board.unmakeMove(undo);
+        out << toString(move) << ": " << count << "\n";
+        nodes += count;
+    }
+
+    const double seconds = secondsSince(start);
+    out << "\nNodes: " << nodes << "\nTime: " << seconds << "s"
+        << "\nNodes/second: " << (u64)(nodes / seconds) << std::endl;
+    return nodes;
+}
+
+auto runSuite(u8 maxDepth, std::ostream &out) -> bool {
+    bool passed = true;
+    u64 totalNodes = 0U;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const Position &position : SUITE) {
+        Board board;
+        if (!FEN::fromFEN(&board, position.fen)) {
+            out << position.name << ": invalid FEN" << std::endl;
+            passed = false;
+            continue;
+        }
+
+        for (u8 depth = 1; depth <= maxDepth && depth <= position.counts.size();
+             ++depth) {
+            const auto positionStart = std::chrono::steady_clock::now();
+            const u64 nodes = perft(board, depth);
+            const double seconds = secondsSince(positionStart);
+            const u64 expected = position.counts[depth - 1];
+            totalNodes += nodes;
+
+            out << position.name << " depth " << (int)depth << ": " << nodes;
+            if (nodes == expected)
+                out << " ok";
+            else {
+                out << " FAILED (expected " << expected << ")";
+                passed = false;
+            }
+            out << " (" << (u64)(nodes / seconds) << " nodes/s)" << std::endl;
+        }
+    }
+
+    out << "\n"
+        << (passed ? "All passed" : "FAILED") << "; " << totalNodes
+        << " nodes at " << (u64)(totalNodes / secondsSince(start))
+        << " nodes/s" << std::endl;
+    return passed;
+}
+
+auto checkSampler(u32 samplesPerMove, std::ostream &out) -> bool {
+    bool passed = true;
+    int positions = 0;
+    u64 samples = 0U;
+    double sampleSeconds = 0.0, listSeconds = 0.0;
+    Random random{1U};
+
+    for (const Position &position : SUITE) {
+        Board board;
+        if (!FEN::fromFEN(&board, position.fen)) {
+            out << position.name << ": invalid FEN" << std::endl;
+            passed = false;
+            continue;
+        }
+
+        // Test the position, then every 8th position of a random game.
+        for (int ply = 0; ply < 200; ++ply) {
+            MoveList moves;
+            board.getMoves(moves);
+            if (ply % 8 == 0) {
+                std::vector<u32> counts(moves.size());
+                const u64 n = u64{samplesPerMove} * moves.size();
+                Move move;
+                bool legal = true;
+
+                for (u64 i = 0; i < n && legal; ++i) {
+                    legal = board.randomMove(random, move);
+                    const auto found =
+                        std::find(moves.begin(), moves.end(), move);
+                    if (found == moves.end())
+                        legal = false;
+                    else
+                        ++counts[found - moves.begin()];
+                }
+                if (moves.empty())
+                    legal = !board.randomMove(random, move);
+
+                // Time it against generating every move and picking one.
+                const auto start = std::chrono::steady_clock::now();
+                for (u64 i = 0; i < n; ++i)
+                    board.randomMove(random, move);
+                sampleSeconds += secondsSince(start);
+                const auto listStart = std::chrono::steady_clock::now();
+                for (u64 i = 0; i < n; ++i) {
+                    MoveList all;
+                    board.getMoves(all);
+                    move = all[random.below(all.size())];
+                }
+                listSeconds += secondsSince(listStart);
+
+                // Chi-squared with moves - 1 degrees of freedom. Fail if a
+                // fair sampler would score this high less than once in a
+                // million times (five standard deviations of a normal,
+                // converted with the Wilson-Hilferty approximation).
+                double chiSquared = 0.0;
+                for (u32 count : counts) {
+                    const double diff = double(count) - samplesPerMove;
+                    chiSquared += diff * diff / samplesPerMove;
+                }
+                const double freedom = moves.size() ? moves.size() - 1 : 0;
+                const double spread = freedom ? 2.0 / (9.0 * freedom) : 0.0;
+                const bool uniform =
+                    chiSquared <=
+                    freedom * std::pow(1.0 - spread + 5.0 * std::sqrt(spread),
+                                       3.0);
+                if (!legal || !uniform) {
+                    out << position.name << " ply " << ply << ": "
+                        << (legal ? "not uniform" : "illegal move")
+                        << " (chi-squared " << chiSquared << ", "
+                        << moves.size() << " moves)" << std::endl;
+                    passed = false;
+                }
+                ++positions;
+                samples += n;
+            }
+            if (moves.empty())
+                break;
+            board.makeMove(moves[random.below(moves.size())]);
+        }
+    }
+
+    out << (passed ? "All passed" : "FAILED") << "; " << positions
+        << " positions, " << samples << " samples; randomMove "
+        << (u64)(samples / sampleSeconds) << " moves/s, getMoves "
+        << (u64)(samples / listSeconds) << " moves/s" << std::endl;
+    return passed;
+}
+} // namespace Perft
@@ -0,0 +1,30 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "Board.h"
+#include <ostream>
+
+// Performance test for move generation: counts every position reachable in
+// exactly N half moves. Known counts for standard positions catch move
+// generation bugs, and nodes/second measures how fast generation is.
+namespace Perft {
+// Returns the number of leaf positions at the specified depth.
+auto perft(Board &board, u8 depth) -> u64;
+
+// Prints the number of leaf positions under each legal move (a "divide"),
+// then the total and nodes/second. Returns the total.
+auto divide(Board &board, u8 depth, std::ostream &out) -> u64;
+
+// Runs perft on a suite of standard positions up to the specified depth and
+// prints the results. Returns whether every count matched.
+auto runSuite(u8 maxDepth, std::ostream &out) -> bool;
+
+// Checks Board::randomMove() on the suite positions, and on positions reached
+// by random play from them: every move it picks must be legal, and every
+// legal move must come up equally often (by a chi-squared test), with the
+// specified number of picks per legal move. Prints the results and the speed
+// compared to picking from getMoves(). Returns whether every position passed.
+auto checkSampler(u32 samplesPerMove, std::ostream &out) -> bool;
+} // namespace Perft
+
+#endif
@@ -1,32 +1,45 @@
 #include "Player.h"
+#include <cerrno>
+#include <cstdlib>
+
+auto parseNumber(const std::string &text, u64 max, u64 &value) -> bool {
+    if (text.empty() || text.find_first_not_of("0123456789") != text.npos)
+        return false;
+    errno = 0;
+    const unsigned long long number = std::strtoull(text.c_str(), nullptr, 10);
+    if (errno == ERANGE || number > max)
+        return false;
+    value = number;
+    return true;
+}
+
+auto ScoringPlayer::setThreads(int threads) -> bool {
+    if (threads < 1)
+        return false;
+    m_pool = threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr;
+    m_boards.resize(threads > 1 ? threads : 0);
+    return true;
+}
 
 // Eval Player
 
 auto EvalPlayer::getMove(Board &board) const -> Move {
-    const std::vector<Move> moves = board.getMoves(color);
-    std::vector<Move> selected;
-    u32 maxScore = 0;
-    for (const auto &move : moves) {
-        u32 score =
-            board.tryMove(move, [this, &board]() { return evalBoard(board); });
-        if (score >= maxScore) {
-            if (score > maxScore) {
-                maxScore = score;
-                selected.clear();
-            }
-            selected.push_back(move);
-        }
-    }
+    MoveList moves;
+    board.getMoves(moves);
+    const MoveList selected =
+        selectMoves(board, moves, [this](Board &b, const Move &move) {
+            return b.tryMove(move, [this, &b]() { return evalBoard(b); });
+        });
     if (selected.size() == 1)
         return selected[0];
     else {
-        return getRandom(selected);
+        return getRandom(selected, m_random);
     }
 }
 
 auto EvalMovesPlayer::getMove(Board &board) const -> Move {
-    const std::vector<Move> moves = board.getMoves(color);
-    std::vector<Move> selected;
+    MoveList moves, selected;
+    board.getMoves(moves);
     u32 maxScore = 0;
     for (const auto &move : moves) {
         u32 score = evalMove(move);
@@ -38,181 +51,123 @@ auto EvalMovesPlayer::getMove(Board &board) const -> Move {
             selected.push_back(move);
         }
     }
-    return getRandom(selected);
+    return getRandom(selected, m_random);
 }
 
 auto EvalPositionPlayer::getMove(Board &board) const -> Move {
-    const std::vector<Move> moves = board.getMoves(color);
-    std::vector<Move> selected;
-    u32 maxScore = 0;
-    for (const auto &move : moves) {
-        // const u8 piece = board.pieceAt ( move.fromCol, move.fromRow );
-        // const u32 score = evalPiece ( piece, move.toCol, move.toRow );
-        u32 score = board.tryMove(
-            move, [&board, &move, &selected, &maxScore, this]() -> u32 {
+    MoveList moves;
+    board.getMoves(moves);
+    const MoveList selected =
+        selectMoves(board, moves, [this](Board &b, const Move &move) {
+            return b.tryMove(move, [&b, this]() -> u32 {
                 u32 thisScore = 0;
-                for (int c = 0; c < GRID_LENGTH; ++c)
-                    for (int r = 0; r < GRID_LENGTH; ++r) {
-                        u8 piece = board.pieceAt(c, r);
-                        if (piece && (piece & COLOR_MASK) == color) {
-                            thisScore += evalPiece(piece, c, r);
-                        }
-                    }
+                for (u64 own = b.pieces(color); own;) {
+                    const u8 square = Bitboard::popFirst(own);
+                    const u8 c = Bitboard::column(square);
+                    const u8 r = Bitboard::row(square);
+                    thisScore += evalPiece(b.pieceAt(c, r), c, r);
+                }
                 return thisScore;
             });
-        if (score >= maxScore) {
-            if (score > maxScore) {
-                maxScore = score;
-                selected.clear();
-            }
-            selected.push_back(move);
-        }
-    }
-    return getRandom(selected);
+        });
+    return getRandom(selected, m_random);
 }
 
 auto EvalPiecePlayer::getMove(Board &board) const -> Move {
-    const std::vector<Move> moves = board.getMoves(color);
-    std::vector<Move> selected;
-    u32 maxScore = 0;
-    for (const auto &move : moves) {
-        const u8 piece = board.pieceAt(move.fromCol, move.fromRow);
-        const u32 score = evalPiece(piece, move.toCol, move.toRow);
-        if (score >= maxScore) {
-            if (score > maxScore) {
-                maxScore = score;
-                selected.clear();
-            }
-            selected.push_back(move);
-        }
-    }
+    MoveList moves;
+    board.getMoves(moves);
+    const MoveList selected =
+        selectMoves(board, moves, [this](Board &b, const Move &move) {
+            const u8 piece = b.pieceAt(move.fromCol, move.fromRow);
+            return static_cast<u32>(evalPiece(piece, move.toCol, move.toRow));
+        });
     m_move++;
-    return getRandom(selected);
+    return getRandom(selected, m_random);
 }
 
 // Random
 
 auto RandomPlayer::getMove(Board &board) const -> Move {
-    const auto &moves = board.getMoves(color);
-    return getRandom(moves);
+    Move move;
+    board.randomMove(m_random, move);
+    return move;
 }
 
 // White moves
 
 auto WhiteSquares::evalBoard(Board &board) const -> u32 {
-    int countWhite = 0;
-    for (int c = 0; c < GRID_LENGTH; ++c)
-        for (int r = 0; r < GRID_LENGTH; ++r) {
-            u8 piece = board.pieceAt(c, r);
-            if (piece != EMPTY && (piece & COLOR_MASK) == color) {
-                if (board.colorAt(c, r) == WHITE)
-                    countWhite++;
-            }
-        }
-    return countWhite;
+    return Bitboard::count(board.pieces(color) & Bitboard::WHITE_TILES);
 }
 
 // Black squares.
 auto BlackSquares::evalBoard(Board &board) const -> u32 {
-    int countBlack = 0;
-    for (int c = 0; c < GRID_LENGTH; ++c)
-        for (int r = 0; r < GRID_LENGTH; ++r) {
-            u8 piece = board.pieceAt(c, r);
-
-            if (piece != EMPTY && (piece & COLOR_MASK) == color) {
-                if (board.colorAt(c, r) == BLACK)
-                    countBlack++;
-            }
-        }
-    return countBlack;
+    return Bitboard::count(board.pieces(color) & ~Bitboard::WHITE_TILES);
 }
 
 // Min opponent moves.
 auto MinimizeOpponentMoves::evalBoard(Board &board) const -> u32 {
-    u8 oppColor = color == WHITE ? BLACK : WHITE;
-    return 100 - board.getMoves(oppColor).size();
+    return 100 - board.countMoves(color == WHITE ? BLACK : WHITE);
 }
 
 // Max opponent moves.
 auto MaximizeOpponentMoves::evalBoard(Board &board) const -> u32 {
-    u8 oppColor = color == WHITE ? BLACK : WHITE;
-    return board.getMoves(oppColor).size();
+    return board.countMoves(color == WHITE ? BLACK : WHITE);
 }
 
 // Min self moves.
+// Scored after our move, when it's the opponent's turn, these have always
+// counted the opponent's replies; that is kept, as a fixed player so a
+// search sees the same count at every depth.
 auto MinimizeOwnMoves::evalBoard(Board &board) const -> u32 {
-    return 100 - board.getMoves(color).size();
+    return 100 - board.countMoves(color == WHITE ? BLACK : WHITE);
 }
 
-// Max self moves.
+// Max self moves. (Counts the opponent's replies, as above.)
 auto MaximizeOwnMoves::evalBoard(Board &board) const -> u32 {
-    return board.getMoves(color).size();
+    return board.countMoves(color == WHITE ? BLACK : WHITE);
 }
 
 // Defensive.
 auto Defensive::evalBoard(Board &board) const -> u32 {
-    u8 pieces = 0;
-    u8 piecesAttacked = 0;
-    for (int c = 0; c < GRID_LENGTH; ++c)
-        for (int r = 0; r < GRID_LENGTH; ++r) {
-            u8 piece = board.pieceAt(c, r);
-            if (piece && ((piece & COLOR_MASK) == color)) {
-                pieces++;
-                if (board.isAttacked(c, r))
-                    piecesAttacked++;
-            }
-        }
-    return (100 * pieces) - piecesAttacked;
+    const u8 enemy = (color == BLACK ? WHITE : BLACK);
+    const u64 pieces = board.pieces(color);
+    u8 piecesHanging = 0;
+    for (u64 attacked = pieces & board.attackMap(enemy); attacked;) {
+        const u8 square = Bitboard::popFirst(attacked);
+        if (board.see(Bitboard::column(square), Bitboard::row(square)) > 0)
+            piecesHanging++;
+    }
+    return (100 * Bitboard::count(pieces)) - piecesHanging;
 }
 
 // Suicidal.
 auto Suicidal::evalBoard(Board &board) const -> u32 {
-    u8 pieces = 0;
-    u8 piecesAttacked = 0;
-    for (int c = 0; c < GRID_LENGTH; ++c)
-        for (int r = 0; r < GRID_LENGTH; ++r) {
-            u8 piece = board.pieceAt(c, r);
-            if (piece && (piece & COLOR_MASK) == color) {
-                pieces++;
-                if (board.isAttacked(c, r))
-                    piecesAttacked++;
-            }
-        }
-    return (UINT32_MAX - (100 * pieces)) + piecesAttacked;
+    const u8 enemy = (color == BLACK ? WHITE : BLACK);
+    const u64 pieces = board.pieces(color);
+    const u64 attacked = pieces & board.attackMap(enemy);
+    return (UINT32_MAX - (100 * Bitboard::count(pieces))) +
+           Bitboard::count(attacked);
 }
 
 // Pacifist.
 auto Pacifist::evalBoard(Board &board) const -> u32 {
-    u8 pieces = 0;
-    u8 piecesAttacked = 0;
-    u8 enemy = (color == BLACK ? WHITE : BLACK);
-    for (int c = 0; c < GRID_LENGTH; ++c)
-        for (int r = 0; r < GRID_LENGTH; ++r) {
-            u8 piece = board.pieceAt(c, r);
-            if (piece && (piece & COLOR_MASK) == enemy) {
-                pieces++;
-                if (board.isAttacked(c, r))
-                    piecesAttacked++;
-            }
-        }
-    return (100 * pieces) - piecesAttacked;
+    const u8 enemy = (color == BLACK ? WHITE : BLACK);
+    const u64 pieces = board.pieces(enemy);
+    const u64 attacked = pieces & board.attackMap(color);
+    return (100 * Bitboard::count(pieces)) - Bitboard::count(attacked);
 }
 
 // Offensive.
 auto Offensive::evalBoard(Board &board) const -> u32 {
-    u8 pieces = 0;
-    u8 piecesAttacked = 0;
-    u8 enemy = (color == BLACK ? WHITE : BLACK);
-    for (int c = 0; c < GRID_LENGTH; ++c)
-        for (int r = 0; r < GRID_LENGTH; ++r) {
-            u8 piece = board.pieceAt(c, r);
-            if (piece && (piece & COLOR_MASK) == enemy) {
-                pieces++;
-                if (board.isAttacked(c, r))
-                    piecesAttacked++;
-            }
-        }
-    return (UINT32_MAX - (100 * pieces)) + piecesAttacked;
+    const u8 enemy = (color == BLACK ? WHITE : BLACK);
+    const u64 pieces = board.pieces(enemy);
+    u8 piecesHanging = 0;
+    for (u64 attacked = pieces & board.attackMap(color); attacked;) {
+        const u8 square = Bitboard::popFirst(attacked);
+        if (board.see(Bitboard::column(square), Bitboard::row(square)) > 0)
+            piecesHanging++;
+    }
+    return (UINT32_MAX - (100 * Bitboard::count(pieces))) + piecesHanging;
 }
 
 auto ClearPath::evalPiece(u8, u8 column, u8) const -> u8 {
@@ -3,17 +3,32 @@
 
 #include "Board.h"
 #include "Move.h"
+#include "MoveList.h"
+#include "Random.h"
+#include "ThreadPool.h"
 #include <functional>
 #include <map>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <random>
+#include <string>
 
-template <typename T> T getRandom(const std::vector<T> &vec) {
-    static std::random_device device;
-    static std::mt19937 mt{device()};
-    std::uniform_int_distribution<> distrib(0, vec.size() - 1);
-    return vec[distrib(mt)];
+// Returns a seed from std::random_device, for when none was given.
+inline auto randomSeed() -> u64 {
+    std::random_device device;
+    return (u64{device()} << 32) ^ device();
+}
+
+// Reads text made up only of decimal digits into value, for player options
+// and the like. Returns false (leaving value alone) if there's anything
+// else in it, or the number is greater than max.
+auto parseNumber(const std::string &text, u64 max, u64 &value) -> bool;
+
+// Returns a random item from a std::vector or MoveList.
+template <typename T>
+auto getRandom(const T &vec, Random &random) -> typename T::value_type {
+    return vec[random.below(vec.size())];
 }
 
 struct Player {
@@ -21,13 +36,81 @@ struct Player {
     virtual ~Player() {}
     virtual auto getMove(Board &) const -> Move = 0;
     inline auto setColor(u8 col) -> void { color = col; };
+    // Lets the player use the specified number of threads. Returns false if
+    // the player can't use more than one.
+    virtual auto setThreads(int threads) -> bool { return threads == 1; }
+    // Seeds the player's random number generator, so that it makes the same
+    // moves every time it is given the same seed and positions.
+    virtual auto setSeed(u64 seed) -> void { m_random = Random{seed}; }
+
+  protected:
+    // The player's own random number generator, for picking between equal
+    // moves. Only used on the thread calling getMove().
+    mutable Random m_random{randomSeed()};
 };
 
-struct EvalPlayer : public Player {
+// Base for players that give every move a score and pick one of the best.
+// With setThreads(), the moves are scored in parallel on a pool of threads
+// kept for the life of the player, each with its own copy of the board.
+struct ScoringPlayer : public Player {
+    auto setThreads(int threads) -> bool override;
+
+  protected:
+    // Scores every move with score(board, move) -> u32 and returns the
+    // moves with the highest score, in the order they were given. The same
+    // moves are returned whether or not threads are used.
+    template <class F>
+    auto selectMoves(Board &board, const MoveList &moves, const F &score) const
+        -> MoveList;
+
+    std::unique_ptr<ThreadPool> m_pool = nullptr;
+    // Each worker's copy of the board, indexed by worker.
+    mutable std::vector<std::optional<Board>> m_boards = {};
+};
+
+template <class F>
+auto ScoringPlayer::selectMoves(Board &board, const MoveList &moves,
+                                const F &score) const -> MoveList {
+    std::array<u32, MoveList::CAPACITY> scores;
+    if (m_pool && moves.size() > 1) {
+        for (auto &copy : m_boards)
+            copy.emplace(board);
+        m_pool->parallelFor(moves.size(), [&](std::size_t i, int worker) {
+            scores[i] = score(*m_boards[worker], moves[i]);
+        });
+    } else {
+        for (std::size_t i = 0; i < moves.size(); ++i)
+            scores[i] = score(board, moves[i]);
+    }
+
+    MoveList selected;
+    u32 maxScore = 0;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        if (scores[i] >= maxScore) {
+            if (scores[i] > maxScore) {
+                maxScore = scores[i];
+                selected.clear();
+            }
+            selected.push_back(moves[i]);
+        }
+    }
+    return selected;
+}
+
+struct EvalPlayer : public ScoringPlayer {
     virtual auto evalBoard(Board &board) const -> u32 = 0;
     auto getMove(Board &board) const -> Move override;
+
+    // Most that capturing the specified piece can change evalBoard() by, up
+    // or down, or UINT32_MAX if unknown. Lets a search skip captures that
+    // can't make a difference (delta pruning).
+    virtual auto captureGain(u8) const -> u32 { return UINT32_MAX; }
 };
 
+// Most a capture can change the score of players that count pieces (100
+// each) and how many of them are attacked (at most 16).
+const static u32 PIECE_COUNT_CAPTURE_GAIN = 116;
+
 // Pure interface for a player who wants to only look at the individual moves.
 // This player has no idea of the board state. Useful for when we want to prefer
 // certain positions, rather than boards.
@@ -39,7 +122,7 @@ struct EvalMovesPlayer : public Player {
 // Interface for a player who wants to rank the position and type of pieces.
 // Player has no idea of the board state or even what move is played to get the
 // pieces to those positions.
-struct EvalPositionPlayer : public Player {
+struct EvalPositionPlayer : public ScoringPlayer {
     virtual auto evalPiece(u8 piece, u8 column, u8 row) const
         -> u8 = 0; // Must return a value 0-255 (higher is better)
     auto getMove(Board &board) const -> Move override;
@@ -47,7 +130,7 @@ struct EvalPositionPlayer : public Player {
 
 // Interface for a player who wants to rank the position and type of a single
 // piece - the one that is about to move. Player has no idea of the board state.
-struct EvalPiecePlayer : public Player {
+struct EvalPiecePlayer : public ScoringPlayer {
     virtual auto evalPiece(u8 piece, u8 column, u8 row) const
         -> u8 = 0; // Must return a value 0-255 (higher is better)
     auto getMove(Board &board) const -> Move override;
@@ -62,10 +145,12 @@ struct RandomPlayer : Player {
 
 struct WhiteSquares : EvalPlayer {
     auto evalBoard(Board &board) const -> u32 override;
+    auto captureGain(u8) const -> u32 override { return 1; }
 };
 
 struct BlackSquares : EvalPlayer {
     auto evalBoard(Board &board) const -> u32 override;
+    auto captureGain(u8) const -> u32 override { return 1; }
 };
 
 struct MinimizeOpponentMoves : EvalPlayer {
@@ -84,24 +169,38 @@ struct MaximizeOwnMoves : EvalPlayer {
     auto evalBoard(Board &board) const -> u32 override;
 };
 
-// A player that minimizes the number of own pieces that are under attack.
+// A player that minimizes the number of own pieces that the opponent can win
+// material by capturing (see Board::see()).
 struct Defensive : EvalPlayer {
     auto evalBoard(Board &board) const -> u32 override;
+    auto captureGain(u8) const -> u32 override {
+        return PIECE_COUNT_CAPTURE_GAIN;
+    }
 };
 
 // A player that maximizes the number of own pieces that are under attack.
 struct Suicidal : EvalPlayer {
     auto evalBoard(Board &board) const -> u32 override;
+    auto captureGain(u8) const -> u32 override {
+        return PIECE_COUNT_CAPTURE_GAIN;
+    }
 };
 
-// A player that maximizes the number of enemy pieces that are under attack.
+// A player that maximizes the number of enemy pieces that it can win material
+// by capturing (see Board::see()).
 struct Offensive : EvalPlayer {
     auto evalBoard(Board &board) const -> u32 override;
+    auto captureGain(u8) const -> u32 override {
+        return PIECE_COUNT_CAPTURE_GAIN;
+    }
 };
 
 // A player that minimizes the number of enemy pieces that are under attack.
 struct Pacifist : EvalPlayer {
     auto evalBoard(Board &board) const -> u32 override;
+    auto captureGain(u8) const -> u32 override {
+        return PIECE_COUNT_CAPTURE_GAIN;
+    }
 };
 
 struct ClearPath : EvalPositionPlayer {
@@ -0,0 +1,73 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "Types.h"
+#include <array>
+#include <limits>
+
+// Small, fast random number generator (xoshiro256++), for when std::mt19937
+// is too slow, e.g. random playouts. Meets the requirements of a
+// UniformRandomBitGenerator, so it also works with <random> and std::shuffle.
+// Not thread safe; give each thread its own.
+struct Random {
+    using result_type = u64;
+
+    // Any seed is fine, including 0.
+    explicit Random(u64 seed) {
+        // Fill the state with splitmix64, as recommended by the authors, so
+        // that similar seeds give unrelated sequences.
+        for (u64 &word : m_state) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            u64 z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr auto min() -> u64 { return 0U; }
+    static constexpr auto max() -> u64 {
+        return std::numeric_limits<u64>::max();
+    }
+
+    auto operator()() -> u64 {
+        const u64 result = rotate(m_state[0] + m_state[3], 23) + m_state[0];
+        const u64 t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotate(m_state[3], 45);
+        return result;
+    }
+
+    // Returns a number from 0 to bound - 1, all equally likely. bound must
+    // not be 0.
+    auto below(u64 bound) -> u64 {
+        // Reject the lowest (2^64 % bound) numbers, so that what is left is
+        // a whole number of runs of 0 to bound - 1.
+        const u64 threshold = -bound % bound;
+        for (;;) {
+            const u64 r = (*this)();
+            if (r >= threshold)
+                return r % bound;
+        }
+    }
+
+  private:
+    static constexpr auto rotate(u64 x, int k) -> u64 {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::array<u64, 4> m_state = {};
+};
+
+// Returns the seed for the numbered part (e.g. a game, or a player in it) of
+// a run started from seed. Each part gets unrelated numbers, however many
+// parts there are and whatever order they run in.
+inline auto deriveSeed(u64 seed, u64 index) -> u64 {
+    return Random{seed ^ (index * 0xD1342543DE82EF95ULL)}();
+}
+
+#endif
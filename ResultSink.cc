@@ -0,0 +1,78 @@
+#include "ResultSink.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+// Longest binary record: the fixed fields, then two names of up to 255
+// characters and their lengths.
+constexpr std::size_t MAX_RECORD = 16 + 2 * 256;
+
+// Appends the value to the record, least significant byte first.
+template <class T>
+auto putLittleEndian(std::array<char, MAX_RECORD> &record, std::size_t &size,
+                     T value) -> void {
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        record[size++] = static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+// Appends the name, as a length then the characters.
+auto putName(std::array<char, MAX_RECORD> &record, std::size_t &size,
+             const std::string &name) -> void {
+    const std::size_t length = std::min<std::size_t>(name.size(), UINT8_MAX);
+    record[size++] = static_cast<char>(length);
+    std::copy_n(name.begin(), length, record.begin() + size);
+    size += length;
+}
+} // namespace
+
+TextSink::TextSink(std::ostream &out) : m_out{out} {}
+
+auto TextSink::write(std::size_t game, const std::string &white,
+                     const std::string &black, const GameResult &result)
+    -> void {
+    m_out << "Game " << game << ": " << white << " vs " << black << ": "
+          << result.score() << (result.isAdjudicated() ? " adjudicated" : "")
+          << " (seed " << result.seed << ")\n";
+}
+
+CsvSink::CsvSink(std::ostream &out) : m_out{out} {
+    m_out << "game,white,black,result,outcome,plies,seed,fen\n";
+}
+
+auto CsvSink::write(std::size_t game, const std::string &white,
+                    const std::string &black, const GameResult &result)
+    -> void {
+    // None of the fields have commas in them: player names are bot names
+    // and their options.
+    m_out << game << "," << white << "," << black << "," << result.score()
+          << "," << result.description() << "," << result.plies << ","
+          << result.seed << "," << result.fen() << "\n";
+}
+
+BinarySink::BinarySink(std::ostream &out) : m_out{out} {}
+
+auto BinarySink::write(std::size_t game, const std::string &white,
+                       const std::string &black, const GameResult &result)
+    -> void {
+    std::array<char, MAX_RECORD> record;
+    std::size_t size = 0U;
+    putLittleEndian<u32>(record, size, game);
+    putLittleEndian<u64>(record, size, result.seed);
+    putLittleEndian<u16>(record, size, result.plies);
+    putLittleEndian<u8>(record, size, result.state);
+    putLittleEndian<u8>(record, size, result.whitePoints());
+    putName(record, size, white);
+    putName(record, size, black);
+    m_out.write(record.data(), size);
+}
+
+std::unique_ptr<ResultSink> makeResultSink(const std::string &format,
+                                           std::ostream &out) {
+    if (format == "text")
+        return std::make_unique<TextSink>(out);
+    if (format == "csv")
+        return std::make_unique<CsvSink>(out);
+    if (format == "binary")
+        return std::make_unique<BinarySink>(out);
+    return nullptr;
+}
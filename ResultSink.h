@@ -0,0 +1,64 @@
+#ifndef RESULTSINK_H
+#define RESULTSINK_H
+
+#include "GameResult.h"
+#include <memory>
+#include <ostream>
+#include <string>
+
+// Somewhere to send the results of finished games, e.g. from a Tournament.
+// Only one thread writes to a sink at a time.
+struct ResultSink {
+    virtual ~ResultSink() = default;
+
+    // Records the result of the numbered game (counting from 1) between the
+    // named players.
+    virtual auto write(std::size_t game, const std::string &white,
+                       const std::string &black, const GameResult &result)
+        -> void = 0;
+};
+
+// One line per game, for reading:
+// Game 12: min vs offensive: 1/2-1/2 adjudicated (seed 42)
+struct TextSink : ResultSink {
+    explicit TextSink(std::ostream &out);
+    auto write(std::size_t game, const std::string &white,
+               const std::string &black, const GameResult &result)
+        -> void override;
+
+  private:
+    std::ostream &m_out;
+};
+
+// Comma separated values, with a header line:
+// game,white,black,result,outcome,plies,seed,fen
+struct CsvSink : ResultSink {
+    explicit CsvSink(std::ostream &out);
+    auto write(std::size_t game, const std::string &white,
+               const std::string &black, const GameResult &result)
+        -> void override;
+
+  private:
+    std::ostream &m_out;
+};
+
+// Binary records, little endian, for when there are a lot of games:
+// game (u32), seed (u64), plies (u16), state (u8, a BoardState), white's
+// points (u8, in half points), then each player's name as a length (u8)
+// followed by that many bytes.
+struct BinarySink : ResultSink {
+    explicit BinarySink(std::ostream &out);
+    auto write(std::size_t game, const std::string &white,
+               const std::string &black, const GameResult &result)
+        -> void override;
+
+  private:
+    std::ostream &m_out;
+};
+
+// Returns the sink for the format (text, csv or binary) writing to out, or
+// nullptr if the format isn't recognized.
+std::unique_ptr<ResultSink> makeResultSink(const std::string &format,
+                                           std::ostream &out);
+
+#endif
@@ -1,7 +1,36 @@
 #include "Runner.h"
+#include <cstdlib>
+
+auto Adjudication::set(const std::string &option) -> bool {
+    const auto equals = option.find('=');
+    if (equals == std::string::npos || equals + 1 == option.size())
+        return false;
+    const auto name = option.substr(0, equals);
+    // Every value is a count of plies or material, so only digits are
+    // allowed, and nothing that doesn't fit in the u16 fields.
+    if (option.find_first_not_of("0123456789", equals + 1) !=
+        std::string::npos)
+        return false;
+    const unsigned long value =
+        std::strtoul(option.c_str() + equals + 1, nullptr, 10);
+    if (value > UINT16_MAX)
+        return false;
+    if (name == "draw")
+        drawPlies = value;
+    else if (name == "resign")
+        resignMaterial = value;
+    else if (name == "resignplies")
+        resignPlies = value;
+    else if (name == "maxplies")
+        maxPlies = value;
+    else
+        return false;
+    return true;
+}
 
 Runner::Runner()
-    : m_players(), m_state(STATE_NORMAL), m_winner(0U), m_lastMove() {}
+    : m_players(), m_state(STATE_NORMAL), m_winner(0U), m_lastMove(),
+      m_positions(), m_seed(randomSeed()) {}
 
 auto Runner::addPlayer(u8 color, std::unique_ptr<Player> &&player) -> void {
     assert(color == BLACK || color == WHITE);
@@ -9,8 +38,29 @@ auto Runner::addPlayer(u8 color, std::unique_ptr<Player> &&player) -> void {
     m_players[color] = std::move(player);
 }
 
-auto Runner::createDefaultBoard() -> void {
-    Board &b = getBoard();
+auto Runner::getState() -> BoardState { return m_state; }
+
+auto Runner::getWinner() -> u8 { return m_winner; }
+
+auto Runner::getTurn() -> u8 { return getBoard().whiteMove() ? WHITE : BLACK; }
+
+auto Runner::isAdjudicated() -> bool {
+    return m_state == STATE_ADJUDICATED_DRAW_NO_CAPTURES ||
+           m_state == STATE_ADJUDICATED_DRAW_MAX_LENGTH ||
+           m_state == STATE_ADJUDICATED_RESIGNATION;
+}
+
+auto Runner::setAdjudication(const Adjudication &adjudication) -> void {
+    m_adjudication = adjudication;
+}
+
+auto Runner::setSeed(u64 seed) -> void { m_seed = seed; }
+
+auto Runner::getSeed() const -> u64 { return m_seed; }
+
+auto Runner::createDefaultBoard() -> void { setDefaultBoard(getBoard()); }
+
+auto Runner::setDefaultBoard(Board &b) -> void {
     b.reset();
 
     // Pawns
@@ -32,49 +82,104 @@ auto Runner::createDefaultBoard() -> void {
     }
 }
 
-auto Runner::doMove(Board &b, Move &m) -> void {
-    if (!b.doMove(m))
-        throw std::runtime_error("player attempted an illegal move");
+auto Runner::doMove(Board &b, Move &m) -> std::optional<Undo> {
+    if (!b.isMoveLegal(m)) {
+        m_state = STATE_FORFEIT_ILLEGAL_MOVE;
+        m_winner = b.whiteMove() ? BLACK : WHITE;
+        return std::nullopt;
+    }
+    const int pieces = Bitboard::count(b.pieces(WHITE) | b.pieces(BLACK));
+    const Undo undo = b.makeMove(m);
+    m_pliesSinceCapture =
+        Bitboard::count(b.pieces(WHITE) | b.pieces(BLACK)) < pieces
+            ? 0
+            : m_pliesSinceCapture + 1;
 
     m_lastMove = m;
+    m_moves.push_back(m);
     m_fullMoves++;
     m_staleMoveHalfClock = (b.isStale()) ? m_staleMoveHalfClock + 1 : 0;
+    m_positions.push_back(b.hash());
     m_state = b.getBoardState(m_staleMoveHalfClock);
+    if (m_state == STATE_NORMAL && isRepetition())
+        m_state = STATE_FORCED_DRAW_REPETITION;
+    if (m_state == STATE_NORMAL)
+        adjudicate(b);
+    return undo;
 }
 
-auto Runner::run() -> std::string {
+auto Runner::getCounters() const -> Counters {
+    return {m_staleMoveHalfClock, m_fullMoves, m_pliesSinceCapture, m_lead,
+            m_leadPlies};
+}
+
+auto Runner::setCounters(const Counters &counters) -> void {
+    m_staleMoveHalfClock = counters.staleMoveHalfClock;
+    m_fullMoves = counters.fullMoves;
+    m_pliesSinceCapture = counters.pliesSinceCapture;
+    m_lead = counters.lead;
+    m_leadPlies = counters.leadPlies;
+}
+
+auto Runner::adjudicate(Board &b) -> void {
+    const Adjudication &rules = m_adjudication;
+    if (rules.resignMaterial) {
+        const int balance = b.materialValue(WHITE) - b.materialValue(BLACK);
+        const int lead = balance >= rules.resignMaterial    ? 1
+                         : balance <= -rules.resignMaterial ? -1
+                                                            : 0;
+        m_leadPlies = lead && lead == m_lead ? m_leadPlies + 1 : 1;
+        m_lead = lead;
+        if (lead && m_leadPlies >= rules.resignPlies) {
+            m_state = STATE_ADJUDICATED_RESIGNATION;
+            m_winner = lead > 0 ? WHITE : BLACK;
+            return;
+        }
+    }
+    if (rules.drawPlies && m_pliesSinceCapture >= rules.drawPlies)
+        m_state = STATE_ADJUDICATED_DRAW_NO_CAPTURES;
+    else if (rules.maxPlies && m_positions.size() > rules.maxPlies)
+        m_state = STATE_ADJUDICATED_DRAW_MAX_LENGTH;
+}
+
+auto Runner::isRepetition() const -> bool {
+    // A position can only repeat since the last pawn move or capture, and
+    // only every other half move (same player to move).
+    const int current = m_positions.size() - 1;
+    const int oldest = std::max(0, current - m_staleMoveHalfClock);
+    int seen = 1;
+    for (int i = current - 2; i >= oldest; i -= 2)
+        if (m_positions[i] == m_positions[current] && ++seen == 3)
+            return true;
+    return false;
+}
+
+auto Runner::run() -> GameResult {
     Board &board = getBoard();
     board.reset();
     createDefaultBoard();
+    m_positions.assign(1, board.hash());
+    m_moves.clear();
+    m_pliesSinceCapture = 0;
+    m_lead = 0;
+    m_leadPlies = 0;
+    for (auto &[color, player] : m_players)
+        if (player)
+            player->setSeed(deriveSeed(m_seed, color));
 
     for (;;) {
         if (tick())
             break;
     }
-    // after we're done, return a FEN of the final board state.
+
     Board &final = getBoard();
-    BoardState state = final.getBoardState(m_staleMoveHalfClock);
-    std::ostringstream oss;
-    switch (state) {
-    case STATE_CHECKMATE: {
-        const u8 winner = final.whiteMove() ? BLACK : WHITE;
-        oss << "Checkmate (" << (winner == WHITE ? "White" : "Black")
-            << " wins)";
-        break;
-    }
-    case STATE_STALEMATE:
-        oss << "Stalemate";
-        break;
-    case STATE_FORCED_DRAW_FIFTY_MOVES:
-        oss << "Draw by 50 move rule";
-        break;
-    case STATE_FORCED_DRAW_INSUFFICIENT_MATERIAL:
-        oss << "Draw by insufficient material";
-        break;
-    case STATE_NORMAL:
-    default:
-        oss << "Game terminated abruptly";
-    }
-    oss << "\n" << FEN::toFEN(&final, m_staleMoveHalfClock, m_fullMoves);
-    return oss.str();
-}
\ No newline at end of file
+    if (m_state == STATE_CHECKMATE)
+        m_winner = final.whiteMove() ? BLACK : WHITE;
+    return GameResult{m_state,
+                      m_winner,
+                      static_cast<u16>(m_moves.size()),
+                      m_staleMoveHalfClock,
+                      m_seed,
+                      final,
+                      m_moves};
+}
@@ -1,24 +1,65 @@
 #ifndef RUNNER_H
 #define RUNNER_H
 
+#include <algorithm>
 #include <assert.h>
+#include <optional>
 #include <sstream>
 #include <stack>
 #include <unordered_map>
 
 #include "Board.h"
 #include "FEN.h"
+#include "GameResult.h"
 #include "Player.h"
 #include "Viewer.h"
 
+// Optional rules for ending a game early, when playing on is pointless. All
+// are off by default.
+struct Adjudication {
+    // Draw after this many plies without a capture. (0 for never.)
+    u16 drawPlies = 0U;
+    // A player behind by at least this much material (a pawn is 100) for
+    // resignPlies plies in a row resigns. (0 for never.)
+    int resignMaterial = 0;
+    u16 resignPlies = 10U;
+    // Draw once the game is this many plies long. (0 for no limit.)
+    u16 maxPlies = 0U;
+
+    // Sets an option from the command line: draw=<plies>,
+    // resign=<material>, resignplies=<plies> or maxplies=<plies>. Returns
+    // false if the option isn't recognized, or its value isn't a number
+    // from 0 to 65535.
+    auto set(const std::string &option) -> bool;
+};
+
 struct Runner {
     Runner();
     virtual ~Runner() = default;
 
     auto addPlayer(u8 color, std::unique_ptr<Player> &&player) -> void;
+    // Returns how the game ended, or STATE_NORMAL if it hasn't.
     auto getState() -> BoardState;
+    // Returns the winner (WHITE or BLACK), if the game ended in checkmate.
     auto getWinner() -> u8;
-    auto run() -> std::string;
+    // Returns the player whose move it is (WHITE or BLACK).
+    auto getTurn() -> u8;
+    // Returns whether the game was ended by the adjudication rules.
+    auto isAdjudicated() -> bool;
+    // Plays the game to the end and returns how it went. A player who tries
+    // an illegal move loses (STATE_FORFEIT_ILLEGAL_MOVE).
+    auto run() -> GameResult;
+
+    // Sets the seed the players' random number generators are seeded from,
+    // so the game can be played again. (Otherwise one is picked at random.)
+    auto setSeed(u64 seed) -> void;
+    auto getSeed() const -> u64;
+
+    // Sets the rules for ending the game early.
+    auto setAdjudication(const Adjudication &adjudication) -> void;
+
+    // Sets up the board with the pieces in their starting positions.
+    static auto setDefaultBoard(Board &b) -> void;
 
   protected:
     std::map<u8, std::unique_ptr<Player>> m_players;
@@ -27,9 +68,39 @@ struct Runner {
     Move m_lastMove;
     u16 m_staleMoveHalfClock = 0U;
     u16 m_fullMoves = 0U;
+    // Hashes of every position in the game so far, for threefold repetition.
+    std::vector<u64> m_positions;
+    // Moves played so far.
+    std::vector<Move> m_moves = {};
+    u64 m_seed;
+    Adjudication m_adjudication = {};
+    u16 m_pliesSinceCapture = 0U;
+    // Player ahead by at least Adjudication::resignMaterial (or 0 for
+    // neither; 1 for white, -1 for black), and for how many plies.
+    int m_lead = 0;
+    u16 m_leadPlies = 0U;
+
+    // The counters doMove() moves on, so that RunnerUI can put them back
+    // when it takes a move back.
+    struct Counters {
+        u16 staleMoveHalfClock = 0U;
+        u16 fullMoves = 0U;
+        u16 pliesSinceCapture = 0U;
+        int lead = 0;
+        u16 leadPlies = 0U;
+    };
+    auto getCounters() const -> Counters;
+    auto setCounters(const Counters &counters) -> void;
 
     auto createDefaultBoard() -> void;
-    auto doMove(Board &b, Move &m) -> void;
+    auto isRepetition() const -> bool;
+    // Ends the game if one of the adjudication rules applies.
+    auto adjudicate(Board &b) -> void;
+    // Plays the move and updates the game state, returning what's needed to
+    // take it back. If the move is illegal, the player on move forfeits
+    // (STATE_FORFEIT_ILLEGAL_MOVE), the board is left alone and nullopt is
+    // returned.
+    auto doMove(Board &b, Move &m) -> std::optional<Undo>;
     virtual auto getBoard() -> Board & = 0;
     virtual auto tick() -> bool = 0;
 };
@@ -42,7 +113,17 @@ struct RunnerUI final : public Runner {
     auto tick() -> bool override;
     auto undo() -> void;
 
-    std::vector<Board> m_states;
+    // A move played, and the counters from before it.
+    struct Step {
+        Undo undo = {};
+        Counters counters = {};
+    };
+
+    // Moves played so far, with m_index of them currently on the board. When
+    // stepping back through the game, the moves after m_index are kept so
+    // they can be played forward again.
+    Board m_board = {};
+    std::vector<Step> m_history;
     std::size_t m_index = 0U;
     Viewer m_viewer;
     bool m_paused = false;
@@ -2,9 +2,8 @@
 #include "Runner.h"
 
 RunnerUI::RunnerUI()
-    : Runner(), m_states{},
+    : Runner(), m_history{},
       m_viewer{Config::WindowTitle, Config::WindowWidth, Config::WindowHeight} {
-    m_states.emplace_back();
     m_viewer.onNewMove = [this](Move &move) {
         if (m_players.size() == 2 && m_players[WHITE] != nullptr &&
             m_players[BLACK] != nullptr)
@@ -26,12 +25,17 @@ RunnerUI::RunnerUI()
             ((whiteMove && move.toRow == 7) || (!whiteMove && move.toRow == 0)))
             move.promotion = QUEEN;
 
-        if (b.isMoveLegal(move))
-            doMove(b, move);
+        if (b.isMoveLegal(move)) {
+            // a new move replaces any moves we had stepped back through
+            m_history.resize(m_index);
+            const Counters counters = getCounters();
+            m_history.push_back({*doMove(b, move), counters});
+            m_index++;
+        }
     };
 }
 
-auto RunnerUI::getBoard() -> Board & { return m_states[m_index]; }
+auto RunnerUI::getBoard() -> Board & { return m_board; }
 
 auto RunnerUI::tick() -> bool {
     m_viewer.update();
@@ -48,20 +52,24 @@ auto RunnerUI::tick() -> bool {
     // states
     if (m_state == STATE_NORMAL &&
         (!m_paused || m_viewer.isPressed(SDLK_RIGHT))) {
-        if (m_index == m_states.size() - 1) {
-            Board &currentBoard = m_states.back();
-            Board newBoard(currentBoard);
-            const u8 player = currentBoard.whiteMove() ? WHITE : BLACK;
+        if (m_index == m_history.size()) {
+            const u8 player = m_board.whiteMove() ? WHITE : BLACK;
 
             const std::unique_ptr<Player> &p = m_players[player];
             if (p) {
-                Move move = p->getMove(newBoard);
-                doMove(newBoard, move);
-                m_states.push_back(newBoard);
-                m_index++;
+                Move move = p->getMove(m_board);
+                const Counters counters = getCounters();
+                if (const auto undo = doMove(m_board, move)) {
+                    m_history.push_back({*undo, counters});
+                    m_index++;
+                }
             }
-        } else if (m_index < m_states.size() - 1)
-            m_index++;
+        } else if (m_index < m_history.size()) {
+            // replay a move we stepped back through; doMove() moves the
+            // counters on again and checks for the end of the game
+            Move move = m_history[m_index++].undo.move;
+            doMove(m_board, move);
+        }
 
     }
     // handle undo if we are paused
@@ -80,7 +88,12 @@ auto RunnerUI::tick() -> bool {
 
 auto RunnerUI::undo() -> void {
     if (m_index) {
-        m_index--;
+        const Step &step = m_history[--m_index];
+        m_board.unmakeMove(step.undo);
+        setCounters(step.counters);
+        m_positions.pop_back();
+        m_moves.pop_back();
+        m_lastMove = m_index ? m_history[m_index - 1].undo.move : Move{};
         m_state = STATE_NORMAL;
     }
 }
\ No newline at end of file
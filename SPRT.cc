@@ -0,0 +1,102 @@
+#include "SPRT.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+// Expected score of a player the specified (logistic) Elo stronger.
+auto expectedScore(double elo) -> double {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+} // namespace
+
+auto SPRTOptions::set(const std::string &option) -> bool {
+    double values[4] = {elo0, elo1, alpha, beta};
+    int read = 0;
+    if (std::sscanf(option.c_str(), "%lf,%lf%n", &values[0], &values[1],
+                    &read) != 2)
+        return false;
+    if (option[read]) {
+        int more = 0;
+        if (std::sscanf(option.c_str() + read, ",%lf,%lf%n", &values[2],
+                        &values[3], &more) != 2)
+            return false;
+        read += more;
+    }
+    // Nothing else may follow.
+    if (option[read])
+        return false;
+    if (values[1] <= values[0] || values[2] <= 0.0 || values[2] >= 0.5 ||
+        values[3] <= 0.0 || values[3] >= 0.5)
+        return false;
+    elo0 = values[0];
+    elo1 = values[1];
+    alpha = values[2];
+    beta = values[3];
+    return true;
+}
+
+SPRT::SPRT(const SPRTOptions &options) : m_options{options} {}
+
+auto SPRT::addPair(int halfPoints) -> void {
+    ++m_pentanomial[halfPoints];
+    ++m_pairs;
+}
+
+auto SPRT::llr() const -> double {
+    if (!m_pairs)
+        return 0.0;
+    // Mean and variance of the score per pair (0 to 1). For the variance,
+    // every outcome is given half a pair more, so that it isn't badly
+    // underestimated from the first few pairs (e.g. with nothing but draws
+    // it would be 0) and the test doesn't stop too early.
+    double mean = 0.0;
+    for (std::size_t i = 0; i < m_pentanomial.size(); ++i)
+        mean += m_pentanomial[i] * (i / 4.0);
+    mean /= m_pairs;
+    const double total = m_pairs + 0.5 * m_pentanomial.size();
+    double variance = 0.0;
+    for (std::size_t i = 0; i < m_pentanomial.size(); ++i)
+        variance += (m_pentanomial[i] + 0.5) / total * (i / 4.0 - mean) *
+                    (i / 4.0 - mean);
+
+    // Generalized SPRT: the scores are close enough to normal that the
+    // likelihood ratio comes down to how far the mean is between the
+    // expected scores of the two hypotheses.
+    const double score0 = expectedScore(m_options.elo0);
+    const double score1 = expectedScore(m_options.elo1);
+    return m_pairs * (score1 - score0) * (2.0 * mean - score0 - score1) /
+           (2.0 * variance);
+}
+
+auto SPRT::lowerBound() const -> double {
+    return std::log(m_options.beta / (1.0 - m_options.alpha));
+}
+
+auto SPRT::upperBound() const -> double {
+    return std::log((1.0 - m_options.beta) / m_options.alpha);
+}
+
+auto SPRT::result() const -> Result {
+    const double ratio = llr();
+    if (ratio >= upperBound())
+        return ACCEPT_ELO1;
+    if (ratio <= lowerBound())
+        return ACCEPT_ELO0;
+    return CONTINUE;
+}
+
+auto SPRT::elo() const -> double {
+    double points = 0.0;
+    for (std::size_t i = 0; i < m_pentanomial.size(); ++i)
+        points += m_pentanomial[i] * (i / 4.0);
+    const double score =
+        m_pairs ? std::fmin(std::fmax(points / m_pairs, 1e-6), 1.0 - 1e-6)
+                : 0.5;
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+auto SPRT::pairs() const -> u64 { return m_pairs; }
+
+auto SPRT::pentanomial() const -> const std::array<u64, 5> & {
+    return m_pentanomial;
+}
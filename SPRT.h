@@ -0,0 +1,58 @@
+#ifndef SPRT_H
+#define SPRT_H
+
+#include "Types.h"
+#include <array>
+#include <string>
+
+// Settings for an SPRT.
+struct SPRTOptions {
+    // The two hypotheses: that the first player is elo0, or elo1, Elo
+    // stronger than the second (logistic Elo).
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    // Chance of accepting elo1 when elo0 is true, and the other way round.
+    double alpha = 0.05;
+    double beta = 0.05;
+
+    // Sets the options from the command line: elo0,elo1[,alpha,beta].
+    // Returns false if they can't be parsed or don't make sense.
+    auto set(const std::string &option) -> bool;
+};
+
+// Sequential probability ratio test between two players: after every pair
+// of games (one with each colour) it says whether the results so far are
+// enough to tell which hypothesis is true, so a match can stop as soon as
+// they are.
+//
+// Results are counted per pair, as a pentanomial: how many pairs the first
+// player scored 0, 1/2, 1, 3/2 and 2 points in. Pairs are less noisy than
+// single games, since whatever favours one colour cancels out.
+struct SPRT {
+    enum Result { CONTINUE, ACCEPT_ELO0, ACCEPT_ELO1 };
+
+    explicit SPRT(const SPRTOptions &options);
+
+    // Counts a pair of games, in which the first player scored the specified
+    // number of half points (0 to 4).
+    auto addPair(int halfPoints) -> void;
+
+    // Returns the log likelihood ratio of elo1 against elo0.
+    auto llr() const -> double;
+    auto lowerBound() const -> double;
+    auto upperBound() const -> double;
+    // Returns whether a bound has been crossed.
+    auto result() const -> Result;
+
+    // Returns the Elo difference the results so far point to.
+    auto elo() const -> double;
+    auto pairs() const -> u64;
+    auto pentanomial() const -> const std::array<u64, 5> &;
+
+  private:
+    SPRTOptions m_options;
+    std::array<u64, 5> m_pentanomial = {};
+    u64 m_pairs = 0U;
+};
+
+#endif
@@ -0,0 +1,435 @@
+#include "Search.h"
+#include "MoveGenerator.h"
+#include "MovePicker.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+// Scores are relative to the side to move (higher is better for them), and
+// wide enough to hold any evalBoard() result, positive or negative.
+using Score = int64_t;
+
+constexpr Score INFINITE_SCORE = Score{1} << 62;
+// Score for being checkmated; mates found sooner score further from zero.
+// Above any evalBoard() result, but small enough for the transposition table.
+constexpr Score MATE_SCORE = Score{1} << 34;
+static_assert(MATE_SCORE <= TranspositionTable::MAX_SCORE);
+
+// Longest line we keep track of.
+constexpr u8 MAX_PLY = MAX_SEARCH_DEPTH + 1;
+
+// Helper threads skip some depths, so that they're spread over several depths
+// rather than all searching the same one. Helper i uses entry (i - 1) % 20 and
+// skips blocks of SKIP_SIZE depths, offset by SKIP_PHASE.
+constexpr std::array<u8, 20> SKIP_SIZE = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                          3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+constexpr std::array<u8, 20> SKIP_PHASE = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3,
+                                           4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+// Mate scores are stored in the transposition table relative to the position
+// rather than the root, since the position can be reached at other plies.
+auto toTable(Score score, u8 ply) -> Score {
+    if (score >= MATE_SCORE - MAX_PLY)
+        return score + ply;
+    if (score <= -MATE_SCORE + MAX_PLY)
+        return score - ply;
+    return score;
+}
+
+auto fromTable(Score score, u8 ply) -> Score {
+    if (score >= MATE_SCORE - MAX_PLY)
+        return score - ply;
+    if (score <= -MATE_SCORE + MAX_PLY)
+        return score + ply;
+    return score;
+}
+
+// State for one search, from one root position.
+struct Searcher {
+    Board &board;
+    const EvalPlayer &eval;
+    TranspositionTable &table;
+    // The searching player; evalBoard() scores are from their side.
+    u8 color = WHITE;
+    // Stop once this many nodes have been visited (0 = no limit).
+    u64 maxNodes = 0U;
+    // Set by the main thread to stop the helpers.
+    const std::atomic<bool> *abort = nullptr;
+    // Whether to search captures past the depth limit.
+    bool quiescence = true;
+
+    // Moves from the root position, best first once an iteration is done.
+    MoveList rootMoves = {};
+    u64 nodes = 0U;
+    bool stopped = false;
+
+    // Killer moves and history, for ordering moves.
+    MoveHistory history = {};
+    // Beta cutoffs, and how many of them were from the first move searched.
+    // The closer they are, the better the move ordering.
+    u64 cutoffs = 0U;
+    u64 firstMoveCutoffs = 0U;
+
+    // Principal variation: the best line found from each ply, pv[ply][ply]
+    // to pv[ply][pvLength[ply] - 1]. pv[0] is the line from the root.
+    std::array<std::array<Move, MAX_PLY>, MAX_PLY> pv = {};
+    std::array<u8, MAX_PLY> pvLength = {};
+
+    // Best line of the last finished iteration. While followPv is set we're
+    // still on it, and try its move first.
+    std::array<Move, MAX_PLY> lastPv = {};
+    u8 lastPvLength = 0U;
+    bool followPv = false;
+
+    // Searches deeper and deeper, up to maxDepth, until stopped. Helper
+    // threads (helper > 0) skip some depths. Returns the best move and sets
+    // completed to the deepest search finished.
+    auto iterate(u8 maxDepth, u8 helper, u8 &completed) -> Move;
+
+    // Searches every root move to the specified depth and returns the
+    // score of the best. pv[0] holds the best line, unless stopped.
+    auto searchRoot(u8 depth) -> Score;
+
+    auto negamax(u8 depth, u8 ply, Score alpha, Score beta) -> Score;
+
+    // Searches only captures and promotions, until the position is quiet, so
+    // that positions aren't scored part way through an exchange.
+    auto quiesce(u8 ply, Score alpha, Score beta) -> Score;
+
+    auto evaluate() -> Score;
+    auto updatePv(u8 ply, const Move &move) -> void;
+};
+
+auto Searcher::iterate(u8 maxDepth, u8 helper, u8 &completed) -> Move {
+    Move best = rootMoves[0];
+    completed = 0;
+    for (u8 depth = 1; depth <= maxDepth; ++depth) {
+        if (helper) {
+            const u8 i = (helper - 1) % SKIP_SIZE.size();
+            if ((depth + SKIP_PHASE[i]) / SKIP_SIZE[i] % 2)
+                continue;
+        }
+        const Score score = searchRoot(depth);
+        // Even if stopped part way, a move that beat the last best move
+        // (which is searched first) is better.
+        if (pvLength[0] > 0)
+            best = pv[0][0];
+        if (stopped)
+            break;
+        completed = depth;
+
+        // Search the best line first next time.
+        lastPv = pv[0];
+        lastPvLength = pvLength[0];
+        const auto found = std::find(rootMoves.begin(), rootMoves.end(), best);
+        std::rotate(rootMoves.begin(), found, found + 1);
+
+        // No point looking deeper once we've found a mate.
+        if (std::abs(score) >= MATE_SCORE - MAX_PLY)
+            break;
+    }
+    return best;
+}
+
+auto Searcher::searchRoot(u8 depth) -> Score {
+    Score alpha = -INFINITE_SCORE;
+    pvLength[0] = 0;
+    for (std::size_t i = 0; i < rootMoves.size(); ++i) {
+        followPv = i == 0;
+        const Undo undo = board.makeMove(rootMoves[i]);
+        const Score score = -negamax(depth - 1, 1, -INFINITE_SCORE, -alpha);
+        board.unmakeMove(undo);
+        if (stopped)
+            break;
+        if (score > alpha) {
+            alpha = score;
+            updatePv(0, rootMoves[i]);
+        }
+    }
+    return alpha;
+}
+
+auto Searcher::negamax(u8 depth, u8 ply, Score alpha, Score beta) -> Score {
+    pvLength[ply] = ply;
+    if ((maxNodes && nodes >= maxNodes) ||
+        (abort && abort->load(std::memory_order_relaxed))) {
+        stopped = true;
+        return 0;
+    }
+    ++nodes;
+
+    // Leaves only need to know whether there are any moves, for checkmate.
+    const bool leaf = depth == 0 || ply == MAX_PLY - 1;
+    MoveList moves;
+    if (!leaf)
+        board.getMoves(moves);
+    if (leaf ? board.hasZeroMoves() : moves.empty()) {
+        const u8 side = board.whiteMove() ? WHITE : BLACK;
+        return board.isCheck(side) ? -MATE_SCORE + ply : evaluate();
+    }
+    if (leaf)
+        return quiescence ? quiesce(ply, alpha, beta) : evaluate();
+
+    // If we've searched this position deep enough before, we may already
+    // know its score. Either way, try the best move from then first.
+    const u64 key = board.hash();
+    TranspositionTable::Entry entry;
+    Move priority = {};
+    if (table.probe(key, entry)) {
+        if (entry.depth >= depth) {
+            const Score score = fromTable(entry.score, ply);
+            if (entry.bound == TranspositionTable::BOUND_EXACT ||
+                (entry.bound == TranspositionTable::BOUND_LOWER &&
+                 score >= beta) ||
+                (entry.bound == TranspositionTable::BOUND_UPPER &&
+                 score <= alpha))
+                return score;
+        }
+        priority = entry.move;
+    }
+
+    // Still on the last iteration's best line, so try its move first.
+    if (followPv) {
+        followPv = ply < lastPvLength &&
+                   std::find(moves.begin(), moves.end(), lastPv[ply]) !=
+                       moves.end();
+        if (followPv)
+            priority = lastPv[ply];
+    }
+
+    const Score originalAlpha = alpha;
+    Move best = {};
+    MovePicker picker{board, moves, priority, history, ply};
+    bool first = true;
+    for (Move move; picker.next(move); first = false) {
+        const Undo undo = board.makeMove(move);
+        const Score score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+        board.unmakeMove(undo);
+        followPv = false;
+        if (stopped)
+            return 0;
+        if (score > alpha) {
+            alpha = score;
+            best = move;
+            updatePv(ply, move);
+            if (alpha >= beta) {
+                ++cutoffs;
+                if (first)
+                    ++firstMoveCutoffs;
+                if (!MovePicker::isTactical(board, move))
+                    history.addCutoff(move, ply, depth);
+                break;
+            }
+        }
+    }
+
+    entry.move = best;
+    entry.score = toTable(alpha, ply);
+    entry.depth = depth;
+    entry.bound = alpha >= beta             ? TranspositionTable::BOUND_LOWER
+                  : alpha > originalAlpha ? TranspositionTable::BOUND_EXACT
+                                          : TranspositionTable::BOUND_UPPER;
+    table.store(key, entry);
+    return alpha;
+}
+
+auto Searcher::quiesce(u8 ply, Score alpha, Score beta) -> Score {
+    pvLength[ply] = ply;
+    if ((maxNodes && nodes >= maxNodes) ||
+        (abort && abort->load(std::memory_order_relaxed))) {
+        stopped = true;
+        return 0;
+    }
+    ++nodes;
+
+    // Assume the side to move can do at least as well as the position's
+    // score by not capturing anything ("standing pat").
+    const Score standPat = evaluate();
+    if (standPat >= beta || ply == MAX_PLY - 1)
+        return standPat;
+    alpha = std::max(alpha, standPat);
+
+    MoveList moves;
+    MoveGenerator generator{board, CAPTURE_MOVES | PROMOTION_MOVES};
+    for (Move move; generator.next(move);)
+        moves.push_back(move);
+
+    MovePicker picker{board, moves, {}, history, ply};
+    for (Move move; picker.next(move);) {
+        // Delta pruning: skip captures that can't raise the score to alpha,
+        // even if the captured piece is free.
+        if (!move.promotion) {
+            const u8 victim = board.isEnPassant(move)
+                                  ? u8{PAWN}
+                                  : board.pieceAt(move.toCol, move.toRow);
+            const u32 gain = eval.captureGain(victim);
+            if (gain != UINT32_MAX && standPat + gain <= alpha)
+                continue;
+        }
+        // SEE pruning: skip captures that lose material.
+        if (board.see(move) < 0)
+            continue;
+
+        const Undo undo = board.makeMove(move);
+        const Score score = -quiesce(ply + 1, -beta, -alpha);
+        board.unmakeMove(undo);
+        if (stopped)
+            return 0;
+        if (score > alpha) {
+            alpha = score;
+            updatePv(ply, move);
+            if (alpha >= beta)
+                break;
+        }
+    }
+    return alpha;
+}
+
+auto Searcher::evaluate() -> Score {
+    const Score score = eval.evalBoard(board);
+    const u8 side = board.whiteMove() ? WHITE : BLACK;
+    return side == color ? score : -score;
+}
+
+auto Searcher::updatePv(u8 ply, const Move &move) -> void {
+    pv[ply][ply] = move;
+    for (u8 i = ply + 1; i < pvLength[ply + 1]; ++i)
+        pv[ply][i] = pv[ply + 1][i];
+    pvLength[ply] = std::max<u8>(pvLength[ply + 1], ply + 1);
+}
+} // namespace
+
+auto SearchOptions::set(const std::string &option) -> bool {
+    const auto equals = option.find('=');
+    const auto name = option.substr(0, equals);
+    const auto value =
+        equals == std::string::npos ? std::string{} : option.substr(equals + 1);
+    // Numbers are checked here, and ranges (e.g. of the depth) by
+    // makeSearchPlayer().
+    u64 number = 0U;
+    if (!option.empty() &&
+        option.find_first_not_of("0123456789") == std::string::npos) {
+        if (!parseNumber(option, UINT8_MAX, number))
+            return false;
+        depth = number;
+    } else if (name == "nodes") {
+        if (!parseNumber(value, UINT64_MAX, number))
+            return false;
+        nodes = number;
+    } else if (name == "hash") {
+        if (!parseNumber(value, MAX_HASH_SIZE, number) || !number)
+            return false;
+        hashSize = number;
+    } else if (name == "threads") {
+        if (!parseNumber(value, MAX_THREADS, number))
+            return false;
+        threads = number;
+    } else if (option == "hugepages")
+        hugePages = true;
+    else if (option == "noquiescence")
+        quiescence = false;
+    else if (option == "stats")
+        stats = true;
+    else
+        return false;
+    return true;
+}
+
+SearchPlayer::SearchPlayer(std::unique_ptr<EvalPlayer> &&eval,
+                           const SearchOptions &options)
+    : m_eval{std::move(eval)}, m_options{options},
+      m_table{std::make_unique<TranspositionTable>(options.hashSize,
+                                                   options.hugePages)},
+      m_pool{options.threads > 1
+                 ? std::make_unique<ThreadPool>(options.threads)
+                 : nullptr} {}
+
+auto SearchPlayer::getMove(Board &board) const -> Move {
+    const auto start = std::chrono::steady_clock::now();
+    m_eval->setColor(color);
+    m_table->newSearch();
+    Searcher searcher{board, *m_eval, *m_table, color, m_options.nodes};
+    searcher.quiescence = m_options.quiescence;
+    board.getMoves(searcher.rootMoves);
+    if (searcher.rootMoves.size() <= 1)
+        return searcher.rootMoves[0];
+    // Moves that score the same are played in the order they're searched,
+    // so shuffle them to not play the same game every time.
+    std::shuffle(searcher.rootMoves.begin(), searcher.rootMoves.end(),
+                 m_random);
+
+    // Lazy SMP: helper threads search the same position on their own copy
+    // of the board, sharing the transposition table. They don't report
+    // back; what they store in the table speeds up the main search. Each
+    // searches the moves in a different order, and at different depths.
+    const int helpers = m_options.threads - 1;
+    std::atomic<bool> abort = false;
+    std::vector<Board> boards(helpers, board);
+    std::vector<Searcher> helperSearchers;
+    helperSearchers.reserve(helpers);
+    for (auto &copy : boards) {
+        helperSearchers.push_back(
+            {copy, *m_eval, *m_table, color, 0U, &abort, m_options.quiescence,
+             searcher.rootMoves});
+        auto &moves = helperSearchers.back().rootMoves;
+        std::shuffle(moves.begin(), moves.end(), m_random);
+    }
+    // The main search is index 0, so it's always handed out first, and the
+    // helpers (which only stop once it's done) can't hold it up.
+    u8 completed = 0U;
+    Move best = {};
+    const auto search = [&](std::size_t i, int) {
+        if (i == 0) {
+            best = searcher.iterate(m_options.depth, 0, completed);
+            abort = true;
+        } else {
+            u8 helperCompleted;
+            helperSearchers[i - 1].iterate(MAX_SEARCH_DEPTH, i,
+                                           helperCompleted);
+        }
+    };
+    if (m_pool)
+        m_pool->parallelFor(m_options.threads, search);
+    else
+        search(0, 0);
+
+    if (m_options.stats) {
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        u64 nodes = searcher.nodes;
+        u64 cutoffs = searcher.cutoffs;
+        u64 firstMoveCutoffs = searcher.firstMoveCutoffs;
+        for (const auto &helper : helperSearchers) {
+            nodes += helper.nodes;
+            cutoffs += helper.cutoffs;
+            firstMoveCutoffs += helper.firstMoveCutoffs;
+        }
+        std::cerr << "search: depth " << static_cast<int>(completed) << ", "
+                  << m_options.threads << " threads, " << nodes << " nodes, "
+                  << static_cast<u64>(nodes / elapsed.count())
+                  << " nodes/second, "
+                  << (cutoffs ? 100.0 * firstMoveCutoffs / cutoffs : 0.0)
+                  << "% first move cutoffs, table "
+                  << m_table->size() / 1024 / 1024
+                  << "MB, " << 100.0 * m_table->hitRate() << "% hits, "
+                  << m_table->collisions() << " collisions" << std::endl;
+    }
+    return best;
+}
+
+std::unique_ptr<Player> makeSearch() {
+    return makeSearchPlayer(makeDefensive(), SearchOptions{});
+}
+
+std::unique_ptr<Player> makeSearchPlayer(std::unique_ptr<Player> &&eval,
+                                         const SearchOptions &options) {
+    if (!dynamic_cast<EvalPlayer *>(eval.get()) || options.depth < 1 ||
+        options.depth > MAX_SEARCH_DEPTH || options.threads < 1)
+        return nullptr;
+    auto evalPlayer =
+        std::unique_ptr<EvalPlayer>{static_cast<EvalPlayer *>(eval.release())};
+    return std::make_unique<SearchPlayer>(std::move(evalPlayer), options);
+}
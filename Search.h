@@ -0,0 +1,75 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "Board.h"
+#include "Player.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+#include <memory>
+#include <string>
+
+// Deepest search we allow.
+const static u8 MAX_SEARCH_DEPTH = 32;
+// Largest transposition table allowed, in megabytes.
+const static std::size_t MAX_HASH_SIZE = std::size_t{1} << 20;
+
+// Settings for a SearchPlayer.
+struct SearchOptions {
+    // How many plies to look ahead, 1 to MAX_SEARCH_DEPTH.
+    int depth = 4;
+    // Stop once the main search has visited this many positions for a move.
+    // Helper threads aren't counted; they stop when it does. (0 for no
+    // limit.)
+    u64 nodes = 0U;
+    // Size of the transposition table in megabytes, and whether to ask for
+    // huge pages for it.
+    std::size_t hashSize = 16U;
+    bool hugePages = false;
+    // Threads to search with. Extra threads search the same position,
+    // sharing the transposition table (Lazy SMP).
+    int threads = 1;
+    // Whether to carry on searching captures past the depth limit.
+    bool quiescence = true;
+    // Print statistics to std::cerr after each move.
+    bool stats = false;
+
+    // Sets an option from the command line: a number is the depth, or one of
+    // nodes=<n>, hash=<megabytes>, threads=<n>, hugepages, noquiescence or
+    // stats. Returns false if the option isn't recognized, or its value
+    // isn't a number in range.
+    auto set(const std::string &option) -> bool;
+};
+
+// A player that looks several moves ahead, scoring the positions it reaches
+// with the evalBoard() of another player (e.g. Defensive), and assuming the
+// opponent will always pick the reply that scores worst for us.
+//
+// Uses negamax alpha-beta with iterative deepening: it searches one ply deep,
+// then two, and so on, each time trying the best line found so far (the
+// principal variation) first so that more of the tree can be cut off.
+// At the depth limit, captures are searched on until the position is quiet
+// (quiescence search). Positions already searched are remembered in a
+// transposition table, which helper threads can share to search faster.
+struct SearchPlayer : Player {
+    SearchPlayer(std::unique_ptr<EvalPlayer> &&eval,
+                 const SearchOptions &options);
+    auto getMove(Board &board) const -> Move override;
+
+  protected:
+    std::unique_ptr<EvalPlayer> m_eval;
+    SearchOptions m_options;
+    std::unique_ptr<TranspositionTable> m_table;
+    // Threads for the helper searches, kept between moves (nullptr for one
+    // thread).
+    std::unique_ptr<ThreadPool> m_pool = nullptr;
+};
+
+// Default search player (Defensive, 4 plies).
+std::unique_ptr<Player> makeSearch();
+
+// Search player using the evalBoard() of the specified player. Returns nullptr
+// if the player isn't an EvalPlayer, or the depth is out of range.
+std::unique_ptr<Player> makeSearchPlayer(std::unique_ptr<Player> &&eval,
+                                         const SearchOptions &options);
+
+#endif
@@ -0,0 +1,62 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads) {
+    for (int worker = 1; worker < threads; ++worker)
+        m_threads.emplace_back([this, worker]() { work(worker); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{m_mutex};
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (auto &thread : m_threads)
+        thread.join();
+}
+
+auto ThreadPool::size() const -> int { return m_threads.size() + 1; }
+
+auto ThreadPool::parallelFor(std::size_t count,
+                             const std::function<void(std::size_t, int)> &func)
+    -> void {
+    {
+        std::lock_guard lock{m_mutex};
+        m_func = &func;
+        m_count = count;
+        m_next = 0;
+        m_busy = m_threads.size();
+        ++m_job;
+    }
+    m_start.notify_all();
+    runJob(0);
+
+    std::unique_lock lock{m_mutex};
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+    m_func = nullptr;
+}
+
+auto ThreadPool::work(int worker) -> void {
+    std::size_t job = 0U;
+    for (;;) {
+        {
+            std::unique_lock lock{m_mutex};
+            m_start.wait(lock,
+                         [this, job]() { return m_stop || m_job != job; });
+            if (m_stop)
+                return;
+            job = m_job;
+        }
+        runJob(worker);
+        {
+            std::lock_guard lock{m_mutex};
+            if (--m_busy == 0)
+                m_done.notify_one();
+        }
+    }
+}
+
+auto ThreadPool::runJob(int worker) -> void {
+    for (std::size_t i = m_next++; i < m_count; i = m_next++)
+        (*m_func)(i, worker);
+}
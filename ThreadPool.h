@@ -0,0 +1,59 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Most threads a player's options can ask for.
+const static int MAX_THREADS = 1024;
+
+// A fixed set of threads, started once and kept until the pool is destroyed,
+// so work can be spread over them without starting threads every time.
+struct ThreadPool {
+    // Creates a pool of the specified number of workers (at least 1). The
+    // thread calling parallelFor() is worker 0, so threads - 1 threads are
+    // started.
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &other) = delete;
+    auto operator=(const ThreadPool &other) = delete;
+
+    // Returns the number of workers, including the calling thread.
+    auto size() const -> int;
+
+    // Calls func(index, worker) for every index from 0 to count - 1, spread
+    // over the workers, and returns once they are all done. worker is 0 to
+    // size() - 1, so func can use it to index per-worker state. Only one
+    // thread may call this at a time.
+    auto parallelFor(std::size_t count,
+                     const std::function<void(std::size_t, int)> &func)
+        -> void;
+
+  private:
+    // Waits for work and runs it, until the pool is destroyed.
+    auto work(int worker) -> void;
+    // Takes indices from the current job until there are none left.
+    auto runJob(int worker) -> void;
+
+    std::vector<std::thread> m_threads = {};
+    std::mutex m_mutex{};
+    std::condition_variable m_start{};
+    std::condition_variable m_done{};
+
+    // Current job, and the next index to be taken from it.
+    const std::function<void(std::size_t, int)> *m_func = nullptr;
+    std::size_t m_count = 0U;
+    std::atomic<std::size_t> m_next = 0U;
+    // Incremented for every job, so workers can tell a new one has started.
+    std::size_t m_job = 0U;
+    // Started threads still running the current job.
+    int m_busy = 0;
+    bool m_stop = false;
+};
+
+#endif
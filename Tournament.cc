@@ -0,0 +1,222 @@
+#include "Tournament.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+
+Tournament::Tournament(const std::vector<std::string> &players,
+                       const PlayerFactory &factory,
+                       const TournamentOptions &options)
+    : m_players{players}, m_factory{factory}, m_options{options} {
+    // The SPRT counts pairs of games, one with each colour.
+    if (m_options.sprt) {
+        m_options.games += m_options.games % 2;
+        m_sprt.emplace(*m_options.sprt);
+    }
+    // Pair by pair, so the games of a pairing are next to each other in the
+    // results. The seed depends only on the game's place in this list.
+    for (std::size_t i = 0; i < m_players.size(); ++i)
+        for (std::size_t j = i + 1; j < m_players.size(); ++j)
+            for (int game = 0; game < m_options.games; ++game) {
+                const u64 seed = deriveSeed(m_options.seed, m_games.size());
+                if (game % 2 == 0)
+                    m_games.push_back({i, j, seed});
+                else
+                    m_games.push_back({j, i, seed});
+            }
+}
+
+auto Tournament::run(std::ostream &out) -> bool {
+    for (const auto &name : m_players)
+        if (!m_factory(name)) {
+            out << "Unrecognized player: " << name << std::endl;
+            return false;
+        }
+    if (m_sprt && m_players.size() != 2) {
+        out << "An SPRT needs exactly two players" << std::endl;
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    TextSink text{out};
+    ResultSink &results = m_options.results ? *m_options.results : text;
+    std::mutex mutex;
+    std::size_t finished = 0U;
+    // Set once the SPRT has decided, so the games still queued are skipped.
+    std::atomic<bool> stop = false;
+    // With an SPRT, results are held here until the game is counted, and
+    // then written in order, so the sinks only ever see the games the
+    // decision was based on.
+    std::vector<std::optional<GameResult>> pending(m_sprt ? m_games.size()
+                                                          : 0U);
+    std::size_t written = 0U;
+    const auto write = [&](std::size_t i, const GameResult &result) {
+        const Game &game = m_games[i];
+        if (m_options.pgn)
+            m_options.pgn->write(i + 1, m_players[game.white],
+                                 m_players[game.black], result);
+        results.write(i + 1, m_players[game.white], m_players[game.black],
+                      result);
+    };
+    const auto playGame = [&](std::size_t i, int) {
+        if (stop)
+            return;
+        Game &game = m_games[i];
+        GameResult result = play(game);
+        if (!m_sprt) {
+            // Every game counts, so it can go straight out. The PGN writer
+            // takes games from any thread.
+            if (m_options.pgn)
+                m_options.pgn->write(i + 1, m_players[game.white],
+                                     m_players[game.black], result);
+            std::lock_guard lock{mutex};
+            game.played = true;
+            ++finished;
+            results.write(i + 1, m_players[game.white],
+                          m_players[game.black], result);
+            return;
+        }
+        std::lock_guard lock{mutex};
+        game.played = true;
+        ++finished;
+        pending[i].emplace(std::move(result));
+        if (updateSPRT())
+            stop = true;
+        for (; written < 2 * m_sprt->pairs(); ++written) {
+            write(written, *pending[written]);
+            pending[written].reset();
+        }
+    };
+    if (m_options.threads > 1) {
+        ThreadPool pool{m_options.threads};
+        pool.parallelFor(m_games.size(), playGame);
+    } else {
+        for (std::size_t i = 0; i < m_games.size(); ++i)
+            playGame(i, 0);
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    m_counted = m_sprt ? 2 * m_sprt->pairs() : m_games.size();
+    const auto adjudicated =
+        std::count_if(m_games.begin(), m_games.begin() + m_counted,
+                      [](const Game &game) { return game.adjudicated; });
+
+    out << "\n";
+    printCrosstable(out);
+    if (m_sprt)
+        printSPRT(out);
+    if (adjudicated)
+        out << "\n" << adjudicated << " of " << m_counted
+            << " games adjudicated\n";
+    out << "\n"
+        << finished << " games in " << elapsed.count() << "s ("
+        << finished / elapsed.count() << " games/second, "
+        << m_options.threads << " threads, seed " << m_options.seed << ")"
+        << std::endl;
+    return true;
+}
+
+auto Tournament::play(Game &game) const -> GameResult {
+    RunnerStd runner{m_factory(m_players[game.white]),
+                     m_factory(m_players[game.black])};
+    runner.setSeed(game.seed);
+    runner.setAdjudication(m_options.adjudication);
+    GameResult result = runner.run();
+    game.whitePoints = result.whitePoints();
+    game.adjudicated = result.isAdjudicated();
+    return result;
+}
+
+auto Tournament::updateSPRT() -> bool {
+    for (std::size_t first = 2 * m_sprt->pairs();
+         m_sprt->result() == SPRT::CONTINUE && first + 1 < m_games.size() &&
+         m_games[first].played && m_games[first + 1].played;
+         first += 2)
+        // The first player is white in the first game of each pair.
+        m_sprt->addPair(m_games[first].whitePoints + 2 -
+                        m_games[first + 1].whitePoints);
+    return m_sprt->result() != SPRT::CONTINUE;
+}
+
+auto Tournament::printCrosstable(std::ostream &out) const -> void {
+    // wins[i][j], draws[i][j]: of player i against player j.
+    const std::size_t n = m_players.size();
+    std::vector<std::vector<int>> wins(n, std::vector<int>(n));
+    std::vector<std::vector<int>> draws(n, std::vector<int>(n));
+    std::vector<int> points(n), played(n);
+    for (std::size_t i = 0; i < m_counted; ++i) {
+        const Game &game = m_games[i];
+        if (game.whitePoints == 2)
+            ++wins[game.white][game.black];
+        else if (game.whitePoints == 0)
+            ++wins[game.black][game.white];
+        else {
+            ++draws[game.white][game.black];
+            ++draws[game.black][game.white];
+        }
+        points[game.white] += game.whitePoints;
+        points[game.black] += 2 - game.whitePoints;
+        ++played[game.white];
+        ++played[game.black];
+    }
+
+    // Cells are the row player's wins-draws-losses against the column
+    // player.
+    std::vector<std::vector<std::string>> cells(n, std::vector<std::string>(n));
+    std::size_t width = 0U;
+    for (std::size_t i = 0; i < n; ++i) {
+        width = std::max(width, m_players[i].size());
+        for (std::size_t j = 0; j < n; ++j) {
+            cells[i][j] = i == j ? "-"
+                                 : std::to_string(wins[i][j]) + "-" +
+                                       std::to_string(draws[i][j]) + "-" +
+                                       std::to_string(wins[j][i]);
+            width = std::max(width, cells[i][j].size());
+        }
+    }
+
+    out << std::left << std::setw(width) << "W-D-L";
+    for (const auto &name : m_players)
+        out << "  " << std::setw(width) << name;
+    out << "  Score\n";
+    for (std::size_t i = 0; i < n; ++i) {
+        out << std::setw(width) << m_players[i];
+        for (std::size_t j = 0; j < n; ++j)
+            out << "  " << std::setw(width) << cells[i][j];
+        out << "  " << points[i] / 2.0 << "/" << played[i] << "\n";
+    }
+    out << std::right;
+}
+
+auto Tournament::printSPRT(std::ostream &out) const -> void {
+    const SPRTOptions &options = *m_options.sprt;
+    const auto &pentanomial = m_sprt->pentanomial();
+    out << "\nSPRT " << m_players[0] << " vs " << m_players[1] << " (elo0 "
+        << options.elo0 << ", elo1 " << options.elo1 << ", alpha "
+        << options.alpha << ", beta " << options.beta << "): ";
+    switch (m_sprt->result()) {
+    case SPRT::ACCEPT_ELO0:
+        out << "elo0 accepted";
+        break;
+    case SPRT::ACCEPT_ELO1:
+        out << "elo1 accepted";
+        break;
+    case SPRT::CONTINUE:
+        out << "no decision";
+        break;
+    }
+    out << "\nLLR " << m_sprt->llr() << " (bounds " << m_sprt->lowerBound()
+        << " to " << m_sprt->upperBound() << ") after " << m_sprt->pairs()
+        << " pairs, Elo " << m_sprt->elo() << "\nPentanomial (pairs scoring "
+        << "0, 1/2, 1, 3/2, 2): " << pentanomial[0] << " " << pentanomial[1]
+        << " " << pentanomial[2] << " " << pentanomial[3] << " "
+        << pentanomial[4] << "\n";
+    const std::size_t played =
+        std::count_if(m_games.begin(), m_games.end(),
+                      [](const Game &game) { return game.played; });
+    if (played < m_games.size() || played > m_counted)
+        out << m_games.size() - played << " games cancelled, "
+            << played - m_counted << " played after the decision ignored\n";
+}
@@ -0,0 +1,102 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "GameResult.h"
+#include "PGN.h"
+#include "Player.h"
+#include "ResultSink.h"
+#include "Runner.h"
+#include "SPRT.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Creates a player from its name (e.g. "search:defensive:4"), or returns
+// nullptr if the name isn't recognized.
+using PlayerFactory =
+    std::function<std::unique_ptr<Player>(const std::string &name)>;
+
+// Settings for a Tournament.
+struct TournamentOptions {
+    // Games each pair of players plays, taking turns to be white.
+    int games = 2;
+    // Games played at once.
+    int threads = 1;
+    // Every game is seeded from this and its number, so the same seed plays
+    // the same games whatever the number of threads.
+    u64 seed = 0U;
+    // Stop a match between two players as soon as the SPRT can tell which
+    // is stronger. games is then the most that are played.
+    std::optional<SPRTOptions> sprt = std::nullopt;
+    // Rules for ending games early.
+    Adjudication adjudication = {};
+    // Where each game's result goes as it finishes (with an SPRT, in order,
+    // once it's counted). If not set, a TextSink on the output passed to
+    // run().
+    ResultSink *results = nullptr;
+    // Where every game is recorded as PGN, if set. Games are written as for
+    // results.
+    PGNWriter *pgn = nullptr;
+};
+
+// Headless round robin: every player plays every other player, and the
+// results are printed as a crosstable. With an SPRT, a match between two
+// players stops as soon as the result is clear.
+//
+// Each game gets its own RunnerStd and freshly created players, so games
+// share nothing and can be played on a pool of threads. Threads take the
+// next game as soon as they finish one, so long games don't hold up the
+// rest.
+struct Tournament {
+    Tournament(const std::vector<std::string> &players,
+               const PlayerFactory &factory,
+               const TournamentOptions &options);
+
+    // Plays every game, sending each result to the result sink as it comes
+    // in, and then prints the crosstable to out. Returns false (having
+    // played nothing) if a player name isn't recognized, or there is an
+    // SPRT without exactly two players.
+    auto run(std::ostream &out) -> bool;
+
+  private:
+    struct Game {
+        // Indices into m_players.
+        std::size_t white, black;
+        u64 seed;
+        // Points for white, in half points: 2 for a win, 1 for a draw and 0
+        // for a loss.
+        int whitePoints = 0;
+        bool played = false;
+        bool adjudicated = false;
+    };
+
+    // Plays the game, fills in its points and returns the full result.
+    auto play(Game &game) const -> GameResult;
+
+    // Counts pairs of games for the SPRT, in order, for as long as both
+    // games have been played. Returns whether the SPRT has decided.
+    auto updateSPRT() -> bool;
+
+    // Prints wins, draws and losses between every pair of players, over the
+    // games counted.
+    auto printCrosstable(std::ostream &out) const -> void;
+
+    // Prints the SPRT result.
+    auto printSPRT(std::ostream &out) const -> void;
+
+    std::vector<std::string> m_players;
+    PlayerFactory m_factory;
+    TournamentOptions m_options;
+    std::vector<Game> m_games = {};
+    std::optional<SPRT> m_sprt = std::nullopt;
+    // Games counted in the results: all of them, except that once the SPRT
+    // has decided, later games are cancelled or, if already started,
+    // ignored. That way the same games decide it whatever order they
+    // finish in.
+    std::size_t m_counted = 0U;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+constexpr std::size_t MEGABYTE = 1024 * 1024;
+// Transparent huge pages on x86-64 are 2MB, and need 2MB alignment.
+constexpr std::size_t HUGE_PAGE = 2 * MEGABYTE;
+
+// Entry data layout: bits 0-15 move, 16-21 depth, 22-23 bound, 24-27 age,
+// 28-63 score (signed).
+constexpr int DEPTH_SHIFT = 16;
+constexpr int BOUND_SHIFT = 22;
+constexpr int AGE_SHIFT = 24;
+constexpr int SCORE_SHIFT = 28;
+constexpr u64 DEPTH_BITS = 0x3F;
+constexpr u64 BOUND_BITS = 0x3;
+constexpr u64 AGE_BITS = 0xF;
+} // namespace
+
+TranspositionTable::TranspositionTable(std::size_t megabytes, bool hugePages) {
+    // Round down to a power of two buckets, so a key can be masked into an
+    // index.
+    const std::size_t bytes = std::max<std::size_t>(megabytes, 1) * MEGABYTE;
+    m_bucketCount = std::bit_floor(bytes / sizeof(Bucket));
+
+    const std::size_t size = m_bucketCount * sizeof(Bucket);
+    const std::size_t alignment =
+        hugePages && size >= HUGE_PAGE ? HUGE_PAGE : alignof(Bucket);
+    void *memory = std::aligned_alloc(alignment, size);
+    if (!memory)
+        throw std::bad_alloc{};
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (alignment == HUGE_PAGE)
+        madvise(memory, size, MADV_HUGEPAGE);
+#endif
+    m_buckets = static_cast<Bucket *>(memory);
+    std::uninitialized_value_construct_n(m_buckets, m_bucketCount);
+}
+
+TranspositionTable::~TranspositionTable() {
+    std::destroy_n(m_buckets, m_bucketCount);
+    std::free(m_buckets);
+}
+
+auto TranspositionTable::probe(u64 key, Entry &entry) -> bool {
+    m_probes.fetch_add(1, std::memory_order_relaxed);
+    Bucket &bucket = m_buckets[key & (m_bucketCount - 1)];
+    for (Slot &slot : bucket.slots) {
+        const u64 data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.key.load(std::memory_order_relaxed) ^ data) != key)
+            continue;
+        entry = unpack(data);
+        if (entry.bound == BOUND_NONE)
+            return false;
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+auto TranspositionTable::store(u64 key, const Entry &entry) -> void {
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+    const u8 age = m_age.load(std::memory_order_relaxed);
+    Bucket &bucket = m_buckets[key & (m_bucketCount - 1)];
+
+    // Replace this position's own entry if it has one. Otherwise replace
+    // an empty entry, else the shallowest from an older search, else the
+    // shallowest.
+    Slot *replace = nullptr;
+    int replaceWorth = INT32_MAX;
+    u64 replaceData = 0U;
+    for (Slot &slot : bucket.slots) {
+        const u64 data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.key.load(std::memory_order_relaxed) ^ data) == key) {
+            replace = &slot;
+            replaceData = data;
+            break;
+        }
+        const Entry old = unpack(data);
+        const int worth = old.bound == BOUND_NONE ? -1
+                          : ageOf(data) == age    ? old.depth + 64
+                                                  : old.depth;
+        if (worth < replaceWorth) {
+            replace = &slot;
+            replaceWorth = worth;
+            replaceData = data;
+        }
+    }
+
+    Entry stored = entry;
+    if ((replace->key.load(std::memory_order_relaxed) ^ replaceData) == key) {
+        // Keep the old best move if we didn't find one this time.
+        if (stored.move == Move{})
+            stored.move = unpack(replaceData).move;
+    } else if (replaceWorth >= 64) {
+        m_collisions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const u64 data = pack(stored, age);
+    replace->key.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+auto TranspositionTable::newSearch() -> void {
+    m_age.store((m_age.load(std::memory_order_relaxed) + 1) & AGE_BITS,
+                std::memory_order_relaxed);
+}
+
+auto TranspositionTable::clear() -> void {
+    for (std::size_t i = 0; i < m_bucketCount; ++i)
+        for (Slot &slot : m_buckets[i].slots) {
+            slot.key.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    m_age = 0;
+    m_probes = 0;
+    m_hits = 0;
+    m_stores = 0;
+    m_collisions = 0;
+}
+
+auto TranspositionTable::size() const -> std::size_t {
+    return m_bucketCount * sizeof(Bucket);
+}
+
+auto TranspositionTable::probes() const -> u64 { return m_probes; }
+
+auto TranspositionTable::hits() const -> u64 { return m_hits; }
+
+auto TranspositionTable::stores() const -> u64 { return m_stores; }
+
+auto TranspositionTable::collisions() const -> u64 { return m_collisions; }
+
+auto TranspositionTable::hitRate() const -> double {
+    const u64 probes = m_probes;
+    return probes ? static_cast<double>(m_hits) / probes : 0.0;
+}
+
+auto TranspositionTable::pack(const Entry &entry, u8 age) -> u64 {
+    const Move &m = entry.move;
+    const u64 move = m.fromCol | m.fromRow << 3 | m.toCol << 6 |
+                     m.toRow << 9 | (m.promotion & PIECE_MASK) << 12;
+    const int64_t score = std::clamp(entry.score, -MAX_SCORE, MAX_SCORE);
+    return move | (entry.depth & DEPTH_BITS) << DEPTH_SHIFT |
+           (entry.bound & BOUND_BITS) << BOUND_SHIFT |
+           (age & AGE_BITS) << AGE_SHIFT |
+           static_cast<u64>(score) << SCORE_SHIFT;
+}
+
+auto TranspositionTable::unpack(u64 data) -> Entry {
+    Entry entry;
+    entry.move.fromCol = data & 7;
+    entry.move.fromRow = data >> 3 & 7;
+    entry.move.toCol = data >> 6 & 7;
+    entry.move.toRow = data >> 9 & 7;
+    entry.move.promotion = data >> 12 & PIECE_MASK;
+    entry.depth = data >> DEPTH_SHIFT & DEPTH_BITS;
+    entry.bound = static_cast<Bound>(data >> BOUND_SHIFT & BOUND_BITS);
+    entry.score = static_cast<int64_t>(data) >> SCORE_SHIFT;
+    return entry;
+}
+
+auto TranspositionTable::ageOf(u64 data) -> u8 {
+    return data >> AGE_SHIFT & AGE_BITS;
+}
@@ -0,0 +1,103 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include "Move.h"
+#include "Types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size hash table of search results, keyed by Board::hash(), so a
+// search can reuse what it found when it reaches the same position again by
+// a different order of moves.
+//
+// The table is allocated once and can be shared between several threads
+// without locks. Each entry is two 64-bit words: the packed data, and the key
+// XORed with the data. If two threads write the same entry at once, the words
+// may come from different writes, but then the key no longer matches and the
+// entry is ignored.
+struct TranspositionTable {
+    // How the stored score relates to the real score of the position.
+    enum Bound : u8 {
+        BOUND_NONE = 0,
+        // The real score is at most the stored score (no move beat alpha).
+        BOUND_UPPER = 1,
+        // The real score is at least the stored score (a move beat beta).
+        BOUND_LOWER = 2,
+        BOUND_EXACT = BOUND_UPPER | BOUND_LOWER,
+    };
+
+    // A stored search result.
+    struct Entry {
+        Move move = {};
+        int64_t score = 0;
+        u8 depth = 0U;
+        Bound bound = BOUND_NONE;
+    };
+
+    // Largest score magnitude that can be stored.
+    static constexpr int64_t MAX_SCORE = (int64_t{1} << 35) - 1;
+
+    // Allocates a table of the specified size in megabytes (at least 1).
+    // With hugePages, asks the OS to back it with huge pages (Linux only),
+    // which means fewer TLB misses on big tables.
+    explicit TranspositionTable(std::size_t megabytes, bool hugePages = false);
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable &other) = delete;
+    auto operator=(const TranspositionTable &other) = delete;
+
+    // Looks up the position. Returns true and fills entry if found.
+    auto probe(u64 key, Entry &entry) -> bool;
+
+    // Stores a search result for the position, replacing the entry for the
+    // same position, or else the least useful entry in its bucket.
+    auto store(u64 key, const Entry &entry) -> void;
+
+    // Starts a new search. Entries from older searches are replaced first.
+    auto newSearch() -> void;
+
+    // Empties the table and resets the counters.
+    auto clear() -> void;
+
+    // Size of the table in bytes.
+    auto size() const -> std::size_t;
+
+    // Counters, since the table was created or cleared. A collision is a
+    // store that overwrote a different position's entry from the current
+    // search; lots of them mean the table is too small.
+    auto probes() const -> u64;
+    auto hits() const -> u64;
+    auto stores() const -> u64;
+    auto collisions() const -> u64;
+
+    // Proportion of probes that found their position (0 to 1).
+    auto hitRate() const -> double;
+
+  private:
+    struct Slot {
+        std::atomic<u64> key = 0U;
+        std::atomic<u64> data = 0U;
+    };
+
+    // Slots sharing a cache line; a key can go in any of them.
+    static constexpr std::size_t BUCKET_SLOTS = 4;
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_SLOTS];
+    };
+
+    static auto pack(const Entry &entry, u8 age) -> u64;
+    static auto unpack(u64 data) -> Entry;
+    static auto ageOf(u64 data) -> u8;
+
+    Bucket *m_buckets = nullptr;
+    std::size_t m_bucketCount = 0U;
+    // Search number, so entries from old searches can be told apart.
+    std::atomic<u8> m_age = 0U;
+
+    alignas(64) std::atomic<u64> m_probes = 0U;
+    std::atomic<u64> m_hits = 0U;
+    std::atomic<u64> m_stores = 0U;
+    std::atomic<u64> m_collisions = 0U;
+};
+
+#endif
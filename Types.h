@@ -6,6 +6,7 @@
 using u8 = uint_least8_t;
 using u16 = uint_least16_t;
 using u32 = uint_least32_t;
+using u64 = uint_least64_t;
 
 // Enum to hold information about a piece in 4 bits.
 // For example, this lets us use ROOK | WHITE (a white rook), which would be
@@ -30,6 +31,24 @@ enum BoardState {
     STATE_STALEMATE,
     STATE_FORCED_DRAW_INSUFFICIENT_MATERIAL,
     STATE_FORCED_DRAW_FIFTY_MOVES,
+    STATE_FORCED_DRAW_REPETITION,
+    // Ends decided by the Runner's adjudication rules (see Adjudication)
+    // rather than the rules of chess.
+    STATE_ADJUDICATED_DRAW_NO_CAPTURES,
+    STATE_ADJUDICATED_DRAW_MAX_LENGTH,
+    STATE_ADJUDICATED_RESIGNATION,
+    // The player on move tried an illegal move, and loses.
+    STATE_FORFEIT_ILLEGAL_MOVE,
+};
+
+// Kinds of move, as bits, for generating only some of the legal moves.
+// Captures include en passant and capturing promotions; quiet moves include
+// castling.
+enum MoveKind {
+    CAPTURE_MOVES = 1,
+    PROMOTION_MOVES = 2,
+    QUIET_MOVES = 4,
+    ALL_MOVES = 7,
 };
 
 // Length of the grid. Grid lengths of different sizes (up to 16!) should work,
@@ -125,11 +125,13 @@ auto Viewer::drawTiles(const Board &board, const Move &last) -> void {
     const u8 tileSize = m_width / GRID_LENGTH;
     const bool isMoveZero =
         !last.fromCol && !last.fromRow && !last.toCol && !last.toRow;
+    // kings that are in check
+    const u64 checked = (board.tiles(KING | WHITE) & board.attackMap(BLACK)) |
+                        (board.tiles(KING | BLACK) & board.attackMap(WHITE));
 
     for (u8 x = 0; x < GRID_LENGTH; ++x)
         for (u8 y = 0; y < GRID_LENGTH; ++y) {
             const u8 row = GRID_LENGTH - 1 - y;
-            const u8 piece = board.pieceAt(x, y);
             const SDL_Rect tile{x * tileSize, row * tileSize, tileSize,
                                 tileSize};
 
@@ -145,7 +147,7 @@ auto Viewer::drawTiles(const Board &board, const Move &last) -> void {
                 setColor(LAST_MOVE_COLOR);
             }
             // highlight tile in red, if it is a king in check
-            else if ((piece & TYPE_MASK) == KING && board.isAttacked(x, y)) {
+            else if (checked & Bitboard::bit(Bitboard::square(x, y))) {
                 setColor(ATTACKED_COLOR);
             }
             // default, no special activity
@@ -0,0 +1,54 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "Types.h"
+#include <array>
+
+// Random keys for Zobrist hashing. A board's hash is the XOR of the key for
+// every piece on its tile, plus keys for whose move it is and any en passant
+// column. Unmoved rooks (CASTLE) have their own keys, so castling rights are
+// part of the hash too.
+namespace Zobrist {
+struct Keys {
+    // Indexed by the 4-bit piece (e.g. ROOK | WHITE) and then the tile.
+    std::array<std::array<u64, 64>, 16> pieces;
+    // Indexed by the column of the last double pawn move.
+    std::array<u64, GRID_LENGTH> enPassant;
+    u64 blackMove;
+};
+
+namespace detail {
+// splitmix64, which is good enough for keys and can run at compile time.
+constexpr auto next(u64 &state) -> u64 {
+    u64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr auto makeKeys() -> Keys {
+    Keys keys{};
+    u64 state = 0x636865737376U;
+    for (auto &piece : keys.pieces)
+        for (auto &key : piece)
+            key = next(state);
+    for (auto &key : keys.enPassant)
+        key = next(state);
+    keys.blackMove = next(state);
+    return keys;
+}
+} // namespace detail
+
+inline constexpr Keys KEYS = detail::makeKeys();
+
+// Returns the part of the hash that comes from the board state bits (see
+// Board::m_bits); whose move it is and the en passant column.
+constexpr auto stateKey(u8 bits) -> u64 {
+    u64 key = (bits & BLACKMOVE_MASK) ? KEYS.blackMove : 0U;
+    if (bits & DOUBLE_MASK)
+        key ^= KEYS.enPassant[(bits & PAWN_MASK) >> 2];
+    return key;
+}
+} // namespace Zobrist
+
+#endif
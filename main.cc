@@ -1,9 +1,17 @@
+#include "MCTS.h"
+#include "PGN.h"
+#include "Perft.h"
 #include "Player.h"
 #include "Runner.h"
+#include "Search.h"
+#include "Tournament.h"
 #include <algorithm>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <iterator>
+#include <optional>
+#include <sstream>
 
 using PlayerCreator = std::function<std::unique_ptr<Player>()>;
 
@@ -23,46 +31,174 @@ static const auto playerCreators = std::map<std::string, PlayerCreator>{
     {"edge", makeClearPath},
     {"centre", makeCentre},
     {"bongcloud", makeBongCloud},
+    {"search", makeSearch},
+    {"mcts", makeMCTS},
 };
 
 struct Args {
     bool isHeadless;
+    bool isPerft;
+    bool isTournament;
+    // Seed for the players' random number generators, if given with -seed.
+    std::optional<u64> seed;
+    // Tournament settings, from -games and -threads.
+    std::optional<int> games;
+    std::optional<int> threads;
+    // elo0,elo1[,alpha,beta] from -sprt.
+    std::optional<std::string> sprt;
+    // Options for ending games early, from -adjudicate.
+    std::optional<std::string> adjudication;
+    // format[:file] from -results, for where tournament results go.
+    std::optional<std::string> results;
+    // File to record games to as PGN, from -pgn.
+    std::optional<std::string> pgn;
     std::vector<std::string> players;
 };
 
+// Removes an option that takes a value (e.g. -seed 42) from the arguments,
+// and returns the value if it was there.
+static auto takeValue(std::vector<std::string> &vec, const std::string &name)
+    -> std::optional<std::string> {
+    const auto option = std::find(vec.begin(), vec.end(), name);
+    if (option == vec.end() || option + 1 == vec.end())
+        return std::nullopt;
+    const auto value = option[1];
+    vec.erase(option, option + 2);
+    return value;
+}
+
 static Args parseArgs(int argc, char **argv) {
     auto args = Args{};
-    auto vec = std::vector<std::string>{argv, argv + argc};
+    auto vec = std::vector<std::string>{argv + 1, argv + argc};
     args.isHeadless =
         std::find(vec.begin(), vec.end(), "-headless") != vec.end();
+    args.isPerft = std::find(vec.begin(), vec.end(), "-perft") != vec.end();
+    args.isTournament =
+        std::find(vec.begin(), vec.end(), "-tournament") != vec.end();
+
+    if (const auto seed = takeValue(vec, "-seed")) {
+        u64 value = 0U;
+        if (!parseNumber(*seed, UINT64_MAX, value)) {
+            std::cerr << "Invalid seed: " << *seed << std::endl;
+            std::exit(1);
+        }
+        args.seed = value;
+    }
+    if (const auto games = takeValue(vec, "-games"))
+        args.games = std::atoi(games->c_str());
+    if (const auto threads = takeValue(vec, "-threads"))
+        args.threads = std::atoi(threads->c_str());
+    args.sprt = takeValue(vec, "-sprt");
+    args.adjudication = takeValue(vec, "-adjudicate");
+    args.results = takeValue(vec, "-results");
+    args.pgn = takeValue(vec, "-pgn");
 
-    std::copy_if(
-        vec.begin(), vec.end(), std::back_inserter(args.players),
-        [argv](const auto &arg) { return arg != argv[0] && arg[0] != '-'; });
+    std::copy_if(vec.begin(), vec.end(), std::back_inserter(args.players),
+                 [](const auto &arg) { return arg[0] != '-'; });
 
     return args;
 }
 
+// Splits a player name such as "search:defensive:4" into the name and its
+// options.
+static auto splitName(const std::string &name) -> std::vector<std::string> {
+    auto parts = std::vector<std::string>{};
+    auto stream = std::istringstream{name};
+    for (auto part = std::string{}; std::getline(stream, part, ':');)
+        parts.push_back(part);
+    return parts;
+}
+
+// Creates the named player, or returns nullptr if the name or its options
+// aren't recognized. Search players are named search:<eval>[:<option>...]
+// where eval is any player that ranks boards (e.g. defensive); see
+// SearchOptions for the options. MCTS players are named mcts[:<option>...];
+// see MCTSOptions. Players that score every move can be named e.g.
+// min:threads=8 to score them on 8 threads.
+static auto makePlayer(const std::string &name) -> std::unique_ptr<Player> {
+    const auto parts = splitName(name);
+    if (parts.empty() || !playerCreators.contains(parts[0]))
+        return nullptr;
+    if (parts[0] == "search" && parts.size() > 1) {
+        auto options = SearchOptions{};
+        for (auto part = parts.begin() + 2; part != parts.end(); ++part)
+            if (!options.set(*part))
+                return nullptr;
+        return makeSearchPlayer(makePlayer(parts[1]), options);
+    }
+    if (parts[0] == "mcts") {
+        auto options = MCTSOptions{};
+        for (auto part = parts.begin() + 1; part != parts.end(); ++part)
+            if (!options.set(*part))
+                return nullptr;
+        return makeMCTSPlayer(options);
+    }
+    // Other players only take threads=<n>, for scoring moves in parallel.
+    auto player = playerCreators.at(parts[0])();
+    for (auto part = parts.begin() + 1; part != parts.end(); ++part)
+        if (part->rfind("threads=", 0) != 0 ||
+            !player->setThreads(std::atoi(part->c_str() + 8)))
+            return nullptr;
+    return player;
+}
+
 static auto makePlayers(std::vector<std::string> playerNames) {
     auto players = std::vector<std::unique_ptr<Player>>{};
     std::transform(playerNames.begin(), playerNames.end(),
                    std::back_inserter(players), [](const std::string &name) {
-                       if (playerCreators.contains(name)) {
-                           return playerCreators.at(name)();
+                       if (auto player = makePlayer(name)) {
+                           return player;
                        }
+                       std::cerr << "Unrecognized player: " << name
+                                 << " (assuming `random`)" << std::endl;
                        return makeRandom();
                    });
     return players;
 }
 
-static auto runHeadless(std::vector<std::unique_ptr<Player>> &&players) {
+// Reads adjudication rules such as draw=60:maxplies=400 (see Adjudication).
+// Returns false if one isn't recognized.
+static auto parseAdjudication(const std::string &rules,
+                              Adjudication &adjudication) -> bool {
+    for (const auto &rule : splitName(rules))
+        if (!adjudication.set(rule))
+            return false;
+    return true;
+}
+
+// Opens the file given with -pgn, if any, to append games to. Returns
+// false if it can't be opened.
+static auto openPGN(const Args &args, std::ofstream &file) -> bool {
+    if (!args.pgn)
+        return true;
+    file.open(*args.pgn, std::ios::app);
+    if (!file)
+        std::cerr << "Can't open " << *args.pgn << std::endl;
+    return file.is_open();
+}
+
+static auto runHeadless(const Args &args, const Adjudication &adjudication)
+    -> int {
+    std::ofstream pgn;
+    if (!openPGN(args, pgn))
+        return 1;
+    auto players = makePlayers(args.players);
     auto runner = RunnerStd{std::move(players[0]), std::move(players[1])};
+    if (args.seed)
+        runner.setSeed(*args.seed);
+    runner.setAdjudication(adjudication);
     const auto result = runner.run();
     std::cout << result << std::endl;
+    if (pgn.is_open())
+        PGNWriter{pgn}.write(1, args.players[0], args.players[1], result);
+    return 0;
 }
 
-static auto runViewer(std::vector<std::unique_ptr<Player>> &&players) {
+static auto runViewer(std::vector<std::unique_ptr<Player>> &&players,
+                      std::optional<u64> seed) {
     auto runner = RunnerUI{};
+    if (seed)
+        runner.setSeed(*seed);
     runner.addPlayer(BLACK, std::move(players.back()));
     if (players.size() == 2) { // either player or computer can play as white
         runner.addPlayer(WHITE, std::move(players.front()));
@@ -72,28 +208,142 @@ static auto runViewer(std::vector<std::unique_ptr<Player>> &&players) {
     std::cout << result << std::endl;
 }
 
+// Plays every pair of the named players (or of every player, if none are
+// named) against each other. With -sprt, two players play until the SPRT
+// decides, or -games games (by default 10000) have been played.
+static auto runTournament(const Args &args, const Adjudication &adjudication)
+    -> int {
+    auto names = args.players;
+    if (names.empty())
+        for (const auto &[name, creator] : playerCreators)
+            names.push_back(name);
+
+    auto options = TournamentOptions{};
+    if (args.sprt) {
+        options.sprt = SPRTOptions{};
+        options.games = 10000;
+        if (!options.sprt->set(*args.sprt)) {
+            std::cerr << "Invalid SPRT: " << *args.sprt << std::endl;
+            return 1;
+        }
+    }
+    options.games = args.games.value_or(options.games);
+    options.threads = args.threads.value_or(options.threads);
+    options.seed = args.seed.value_or(randomSeed());
+    options.adjudication = adjudication;
+    if (names.size() < 2 || options.games < 1 || options.threads < 1) {
+        std::cerr << "Invalid tournament" << std::endl;
+        return 1;
+    }
+
+    // Results go to stdout as text unless given as format[:file].
+    std::ofstream file;
+    std::unique_ptr<ResultSink> results;
+    if (args.results) {
+        const auto colon = args.results->find(':');
+        const auto format = args.results->substr(0, colon);
+        if (colon != std::string::npos) {
+            file.open(args.results->substr(colon + 1),
+                      format == "binary" ? std::ios::binary : std::ios::out);
+            if (!file) {
+                std::cerr << "Can't open " << args.results->substr(colon + 1)
+                          << std::endl;
+                return 1;
+            }
+        }
+        results = makeResultSink(format, file.is_open() ? file : std::cout);
+        if (!results) {
+            std::cerr << "Invalid results format: " << format << std::endl;
+            return 1;
+        }
+        options.results = results.get();
+    }
+    std::ofstream pgnFile;
+    if (!openPGN(args, pgnFile))
+        return 1;
+    std::optional<PGNWriter> pgn;
+    if (pgnFile.is_open())
+        options.pgn = &pgn.emplace(pgnFile);
+    auto tournament = Tournament{names, makePlayer, options};
+    return tournament.run(std::cout) ? 0 : 1;
+}
+
+// Runs perft from the starting position or a FEN. args are either
+// [depth] [FEN], suite [depth] or sample [samples per move].
+static auto runPerft(const std::vector<std::string> &args) -> int {
+    if (args.size() >= 1 && args[0] == "suite") {
+        const int depth = args.size() >= 2 ? std::atoi(args[1].c_str()) : 5;
+        return Perft::runSuite(depth, std::cout) ? 0 : 1;
+    }
+    if (args.size() >= 1 && args[0] == "sample") {
+        const int samples =
+            args.size() >= 2 ? std::atoi(args[1].c_str()) : 1000;
+        return Perft::checkSampler(samples, std::cout) ? 0 : 1;
+    }
+
+    const int depth = args.size() >= 1 ? std::atoi(args[0].c_str()) : 0;
+    if (depth < 1 || depth > UINT8_MAX) {
+        std::cerr << "Invalid perft depth" << std::endl;
+        return 1;
+    }
+
+    Board board;
+    if (args.size() >= 2) {
+        if (!FEN::fromFEN(&board, args[1])) {
+            std::cerr << "Invalid FEN: " << args[1] << std::endl;
+            return 1;
+        }
+    } else {
+        Runner::setDefaultBoard(board);
+    }
+    Perft::divide(board, depth, std::cout);
+    return 0;
+}
+
 int main(int argc, char **argv) {
     const auto args = parseArgs(argc, argv);
 
+    if (args.isPerft)
+        return runPerft(args.players);
+    auto adjudication = Adjudication{};
+    if (args.adjudication &&
+        !parseAdjudication(*args.adjudication, adjudication)) {
+        std::cerr << "Invalid adjudication: " << *args.adjudication
+                  << std::endl;
+        return 1;
+    }
+    if (args.isTournament)
+        return runTournament(args, adjudication);
+
     if (args.players.size() == 0 ||
         (args.isHeadless && args.players.size() != 2)) {
         std::cerr << "Invalid configuration"
                   << "\n"
-                  << "Usage: " << argv[0] << " [-headless] [white] black"
+                  << "Usage: " << argv[0]
+                  << " [-headless] [-seed n] [-adjudicate rules] [-pgn file] "
+                     "[white] black"
+                  << "\n"
+                  << "       " << argv[0]
+                  << " -tournament [-games n] [-threads n] [-seed n] "
+                     "[-sprt elo0,elo1[,alpha,beta]]"
+                  << "\n"
+                  << "           [-adjudicate rules] "
+                     "[-results text|csv|binary[:file]] [-pgn file]"
+                  << "\n"
+                  << "           [player...]"
+                  << "\n"
+                  << "       " << argv[0] << " -perft depth [FEN]"
+                  << "\n"
+                  << "       " << argv[0] << " -perft suite [depth]"
+                  << "\n"
+                  << "       " << argv[0] << " -perft sample [samples]"
                   << std::endl;
         std::exit(1);
     }
 
-    for (const auto &name : args.players) {
-        if (!playerCreators.contains(name)) {
-            std::cerr << "Unrecognized player: " << name
-                      << " (assuming `random`)" << std::endl;
-        }
-    }
-
     if (args.isHeadless) {
-        runHeadless(makePlayers(args.players));
+        return runHeadless(args, adjudication);
     } else {
-        runViewer(makePlayers(args.players));
+        runViewer(makePlayers(args.players), args.seed);
     }
 }
\ No newline at end of file